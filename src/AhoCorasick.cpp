@@ -0,0 +1,77 @@
+#include "AhoCorasick.h"
+#include <queue>
+
+AhoCorasick::AhoCorasick() {
+    addNode();
+}
+
+unsigned char AhoCorasick::fold(char c) {
+    auto uc = static_cast<unsigned char>(c);
+    if(uc >= 'A' && uc <= 'Z')
+        return uc - 'A' + 'a';
+    return uc;
+}
+
+uint32_t AhoCorasick::addNode() {
+    transitions.resize(transitions.size() + alphabet_size, 0);
+    outputs.push_back(0);
+    return static_cast<uint32_t>(outputs.size() - 1);
+}
+
+void AhoCorasick::addPattern(std::string_view pattern, uint8_t flags) {
+    if(pattern.empty())
+        return;
+
+    uint32_t node = 0;
+    for(const auto& c : pattern) {
+        auto& next = transitions[node * alphabet_size + fold(c)];
+        if(next == 0) {
+            auto child = addNode(); // invalidates next
+            transitions[node * alphabet_size + fold(c)] = child;
+            node = child;
+        } else {
+            node = next;
+        }
+    }
+    outputs[node] |= flags;
+}
+
+// Turns the trie into a DFA: missing transitions are resolved through the failure links in
+// breadth-first order and outputs are inherited from the failure target.
+void AhoCorasick::compile() {
+    std::vector<uint32_t> fail(outputs.size(), 0);
+    std::queue<uint32_t> queue;
+
+    for(int c = 0; c < alphabet_size; ++c) {
+        auto child = transitions[c];
+        if(child != 0)
+            queue.push(child);
+    }
+
+    while(!queue.empty()) {
+        auto node = queue.front();
+        queue.pop();
+        outputs[node] |= outputs[fail[node]];
+
+        for(int c = 0; c < alphabet_size; ++c) {
+            auto& next = transitions[node * alphabet_size + c];
+            auto fallback = transitions[fail[node] * alphabet_size + c];
+            if(next != 0) {
+                fail[next] = fallback;
+                queue.push(next);
+            } else {
+                next = fallback;
+            }
+        }
+    }
+}
+
+uint8_t AhoCorasick::scan(std::string_view text) const {
+    uint8_t flags = 0;
+    uint32_t node = 0;
+    for(const auto& c : text) {
+        node = transitions[node * alphabet_size + fold(c)];
+        flags |= outputs[node];
+    }
+    return flags;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Case-insensitive multi-pattern matcher. Every pattern carries a set of flag bits; scanning a
+// text returns the union of the flags of all patterns occurring in it. The automaton is a
+// complete DFA, so a scan costs one table lookup per input byte regardless of pattern count.
+class AhoCorasick {
+public:
+    AhoCorasick();
+
+    // Patterns must all be added before compile() is called.
+    void addPattern(std::string_view pattern, uint8_t flags);
+    void compile();
+
+    uint8_t scan(std::string_view text) const;
+
+private:
+    static constexpr int alphabet_size = 256;
+
+    std::vector<uint32_t> transitions; // node * alphabet_size + byte -> node
+    std::vector<uint8_t> outputs;
+
+    uint32_t addNode();
+    static unsigned char fold(char c);
+};
@@ -0,0 +1,58 @@
+#include "AliasTable.h"
+#include <numeric>
+
+AliasTable::AliasTable(const std::vector<double>& weights)
+: probability(weights.size(), 1.0), alias(weights.size(), 0) {
+    auto n = weights.size();
+    auto total = std::accumulate(weights.begin(), weights.end(), 0.0);
+    if(n == 0 || total <= 0.0) {
+        probability.clear();
+        alias.clear();
+        return;
+    }
+
+    std::vector<double> scaled(n);
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for(uint32_t i = 0; i < n; ++i) {
+        scaled[i] = weights[i] * n / total;
+        if(scaled[i] < 1.0)
+            small.push_back(i);
+        else
+            large.push_back(i);
+    }
+
+    while(!small.empty() && !large.empty()) {
+        auto s = small.back();
+        small.pop_back();
+        auto l = large.back();
+
+        probability[s] = scaled[s];
+        alias[s] = l;
+        scaled[l] -= 1.0 - scaled[s];
+        if(scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // Whatever is left is 1 up to rounding errors
+    for(const auto& l : large)
+        probability[l] = 1.0;
+    for(const auto& s : small)
+        probability[s] = 1.0;
+}
+
+size_t AliasTable::size() const {
+    return probability.size();
+}
+
+bool AliasTable::empty() const {
+    return probability.empty();
+}
+
+size_t AliasTable::sample(std::mt19937& rng) const {
+    auto column = std::uniform_int_distribution<size_t>(0, probability.size() - 1)(rng);
+    auto coin = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+    return coin < probability[column] ? column : alias[column];
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Vose's alias method: after O(n) construction every weighted draw costs one bounded random
+// index and one uniform real, independent of the number of weights.
+class AliasTable {
+public:
+    // A table of weights that don't sum to a positive total is empty, nothing can be drawn from it
+    explicit AliasTable(const std::vector<double>& weights);
+
+    size_t size() const;
+    bool empty() const;
+    size_t sample(std::mt19937& rng) const;
+
+private:
+    std::vector<double> probability;
+    std::vector<uint32_t> alias;
+};
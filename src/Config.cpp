@@ -1,46 +1,402 @@
 #include "Config.h"
-#include <Windows.h>
+#include "Console.h"
+#include "FileStamp.h"
+#include "Hash.h"
+#include "MappedFile.h"
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
 #include <filesystem>
+#include <string_view>
+#include <vector>
+#ifdef _WIN32
+#include <Windows.h>
+#endif
 
 std::string Config::base_directory;
 
-std::string Config::worldInventoryRandomizer;
-std::string Config::heroInventoryRandomizer;
-std::string Config::npcInventoryRandomizer;
-std::string Config::stashInventoryRandomizer;
-bool Config::randomizeNPCGrenades;
-bool Config::showDebugConsole;
-bool Config::enableDebugLogging;
-bool Config::logToFile;
-int Config::RNGSeed;
-std::string Config::randomizationScenario;
-
-constexpr auto iniStringBufSize = 32;
+namespace {
+
 constexpr const char* iniMainCategory = "ZHM5Randomizer";
+constexpr const char* iniDebugCategory = "Debug";
+constexpr const char* iniCustomWorldCategory = "Custom.World";
+constexpr const char* iniCustomNPCCategory = "Custom.NPC";
+constexpr const char* iniCategoryWeightsCategory = "CategoryWeights";
+constexpr const char* iniItemWeightsCategory = "ItemWeights";
+
+struct Snapshots {
+    std::atomic<const Config::Snapshot*> current;
+    std::unique_ptr<Config::Snapshot> owner;
+    // Replaced at the last reload, other threads may still read from these
+    std::vector<std::unique_ptr<Config::Snapshot>> retired;
+    FileStamp ini_stamp;
+    FileStamp toml_stamp;
+
+    Snapshots() : owner(std::make_unique<Config::Snapshot>()) {
+        current.store(owner.get(), std::memory_order_release);
+    }
+};
+
+Snapshots& snapshots() {
+    static Snapshots instance;
+    return instance;
+}
+
+std::string iniPath() {
+    return Config::retailPath("ZHM5Randomizer.ini");
+}
+
+std::string tomlPath() {
+    return Config::retailPath("hitman_randomizer.toml");
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if(a.size() != b.size())
+        return false;
+    for(size_t i = 0; i < a.size(); ++i) {
+        if(tolower(static_cast<unsigned char>(a[i])) != tolower(static_cast<unsigned char>(b[i])))
+            return false;
+    }
+    return true;
+}
+
+std::string_view trim(std::string_view s) {
+    auto first = s.find_first_not_of(" \t\r");
+    if(first == std::string_view::npos)
+        return {};
+    auto last = s.find_last_not_of(" \t\r");
+    return s.substr(first, last - first + 1);
+}
+
+// Position of the first c in s that isn't part of a quoted string, or npos
+size_t findUnquoted(std::string_view s, char c) {
+    char quote = 0;
+    for(size_t i = 0; i < s.size(); ++i) {
+        if(quote) {
+            if(s[i] == '\\' && quote == '"')
+                ++i;
+            else if(s[i] == quote)
+                quote = 0;
+        } else if(s[i] == '"' || s[i] == '\'') {
+            quote = s[i];
+        } else if(s[i] == c) {
+            return i;
+        }
+    }
+    return std::string_view::npos;
+}
+
+// Removes the quotes of a TOML basic or literal string. Unquoted ini values are only trimmed.
+std::string unquote(std::string_view s) {
+    s = trim(s);
+    if(s.size() >= 2 && s.front() == '\'' && s.back() == '\'')
+        return std::string(s.substr(1, s.size() - 2));
+    if(s.size() < 2 || s.front() != '"' || s.back() != '"')
+        return std::string(s);
+
+    std::string out;
+    for(size_t i = 1; i + 1 < s.size(); ++i) {
+        if(s[i] != '\\' || i + 2 == s.size()) {
+            out += s[i];
+            continue;
+        }
+        switch(s[++i]) {
+        case 'n':
+            out += '\n';
+            break;
+        case 't':
+            out += '\t';
+            break;
+        default:
+            out += s[i];
+        }
+    }
+    return out;
+}
+
+// Integers as written by GetPrivateProfileInt users, plus TOML booleans
+bool assign(int& out, std::string_view value) {
+    auto text = unquote(value);
+    if(equalsIgnoreCase(text, "true") || equalsIgnoreCase(text, "false")) {
+        out = equalsIgnoreCase(text, "true");
+        return true;
+    }
+    char* end;
+    auto hex = text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X');
+    auto parsed = std::strtoll(text.c_str(), &end, hex ? 16 : 10);
+    if(end == text.c_str())
+        return false;
+    out = static_cast<int>(parsed);
+    return true;
+}
+
+bool assign(bool& out, std::string_view value) {
+    int parsed;
+    if(!assign(parsed, value))
+        return false;
+    out = parsed != 0;
+    return true;
+}
+
+bool assign(std::string& out, std::string_view value) {
+    out = unquote(value);
+    return true;
+}
+
+// Word lists are TOML arrays, e.g. allowed_words = ["coin cure", "kalmer", "pristine"], the
+// brackets may be left out in the ini file
+bool assign(std::vector<std::string>& out, std::string_view value) {
+    value = trim(value);
+    if(!value.empty() && value.front() == '[') {
+        auto close = findUnquoted(value, ']');
+        if(close == std::string_view::npos)
+            return false;
+        value = value.substr(1, close - 1);
+    }
+
+    out.clear();
+    while(!value.empty()) {
+        auto separator = findUnquoted(value, ',');
+        auto word = unquote(value.substr(0, separator));
+        if(!word.empty())
+            out.push_back(std::move(word));
+        if(separator == std::string_view::npos)
+            break;
+        value.remove_prefix(separator + 1);
+    }
+    return true;
+}
+
+// Weights are key = weight pairs, e.g. explosives = 4.5. Negative weights are ignored.
+bool assignWeight(std::unordered_map<std::string, double>& weights, std::string_view key,
+                  std::string_view value) {
+    auto text = unquote(value);
+    char* end;
+    auto weight = std::strtod(text.c_str(), &end);
+    if(end == text.c_str())
+        return false;
+    if(weight >= 0.0)
+        weights[std::string(key)] = weight;
+    return true;
+}
+
+enum class Assignment {
+    Applied,
+    Invalid,
+    Unknown,
+};
+
+Assignment assignment(bool valid) {
+    return valid ? Assignment::Applied : Assignment::Invalid;
+}
+
+#define CONFIG_NAMED_ENTRY(name, cat, key_name)                            \
+    if(equalsIgnoreCase(section, cat) && equalsIgnoreCase(key, key_name))   \
+        return assignment(assign(snapshot.name, value));
+#define CONFIG_ENTRY(name, cat) CONFIG_NAMED_ENTRY(name, cat, #name)
+
+Assignment apply(Config::Snapshot& snapshot, std::string_view section, std::string_view key,
+                 std::string_view value) {
+    CONFIG_ENTRY(worldInventoryRandomizer, iniMainCategory);
+    CONFIG_ENTRY(heroInventoryRandomizer, iniMainCategory);
+    CONFIG_ENTRY(npcInventoryRandomizer, iniMainCategory);
+    CONFIG_ENTRY(stashInventoryRandomizer, iniMainCategory);
+    CONFIG_ENTRY(randomizeNPCGrenades, iniMainCategory);
+    CONFIG_ENTRY(RNGSeed, iniMainCategory);
+    CONFIG_ENTRY(worldItemMaxRepeats, iniMainCategory);
+    CONFIG_ENTRY(orderIndependentWorldItems, iniMainCategory);
+
+    CONFIG_ENTRY(showDebugConsole, iniDebugCategory);
+    CONFIG_ENTRY(enableDebugLogging, iniDebugCategory);
+    CONFIG_ENTRY(logToFile, iniDebugCategory);
+    CONFIG_ENTRY(logLevel, iniDebugCategory);
+
+    CONFIG_NAMED_ENTRY(customWorldAllowedWords, iniCustomWorldCategory, "allowed_words");
+    CONFIG_NAMED_ENTRY(customWorldIgnoredWords, iniCustomWorldCategory, "ignored_words");
+    CONFIG_NAMED_ENTRY(customNPCAllowedWords, iniCustomNPCCategory, "allowed_words");
+    CONFIG_NAMED_ENTRY(customNPCIgnoredWords, iniCustomNPCCategory, "ignored_words");
+
+    if(equalsIgnoreCase(section, iniCategoryWeightsCategory))
+        return assignment(assignWeight(snapshot.categoryWeights, key, value));
+    if(equalsIgnoreCase(section, iniItemWeightsCategory))
+        return assignment(assignWeight(snapshot.itemWeights, key, value));
+    return Assignment::Unknown;
+}
+
+// Strips comments. In TOML files they start with a # outside of strings, anywhere on the line. Ini
+// files only have whole line comments starting with ; or #, a # in a value is part of the value.
+std::string_view stripComment(std::string_view line, bool toml) {
+    line = trim(line);
+    if(toml)
+        return trim(line.substr(0, findUnquoted(line, '#')));
+    if(!line.empty() && (line.front() == ';' || line.front() == '#'))
+        return {};
+    return line;
+}
+
+// Problems found while parsing. They are logged once the new snapshot is published, before that
+// the logging settings of the files being parsed aren't in effect yet.
+struct Diagnostic {
+    Console::Level level;
+    std::string text;
+};
+
+
+// Single pass over an ini or TOML file. Supported are [section] headers (a TOML table name is
+// used as the section name as a whole, [Custom.World] is the Custom.World section), key = value
+// pairs with bare, quoted and dotted keys, basic and literal strings, integers, floats, booleans
+// and string arrays spanning multiple lines. Lines that can't be parsed are reported and skipped.
+void parse(std::string_view text,
+           const char* file_name,
+           bool toml,
+           Config::Snapshot& snapshot,
+           std::vector<Diagnostic>& diagnostics) {
+    if(text.substr(0, 3) == "\xEF\xBB\xBF")
+        text.remove_prefix(3);
+
+    std::string section;
+    std::string value;
+    int line_number = 0;
+    auto nextLine = [&text, &line_number, toml]() {
+        auto end = text.find('\n');
+        auto line = text.substr(0, end);
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+        ++line_number;
+        return stripComment(line, toml);
+    };
+    auto report = [&](Console::Level level, int line, const std::string& message) {
+        auto text = std::string(file_name) + ":" + std::to_string(line) + ": " + message;
+        diagnostics.push_back({ level, std::move(text) });
+    };
+
+    while(!text.empty()) {
+        auto line = nextLine();
+        if(line.empty())
+            continue;
+        auto first_line = line_number;
+
+        if(line.front() == '[') {
+            if(line.size() < 2 || line[1] == '[' || line.back() != ']') {
+                report(Console::Level::Error, first_line, "unsupported section header");
+                section.clear();
+                continue;
+            }
+            section = std::string(trim(line.substr(1, line.size() - 2)));
+            continue;
+        }
+
+        auto separator = findUnquoted(line, '=');
+        if(separator == std::string_view::npos) {
+            report(Console::Level::Error, first_line, "expected key = value");
+            continue;
+        }
+        auto key_text = trim(line.substr(0, separator));
+        value = trim(line.substr(separator + 1));
+        // Arrays continue until their closing bracket
+        if(!value.empty() && value.front() == '[') {
+            while(findUnquoted(value, ']') == std::string::npos && !text.empty())
+                value.append(" ").append(nextLine());
+        }
+
+        auto key_section = section;
+        std::string key;
+        if(!key_text.empty() && (key_text.front() == '"' || key_text.front() == '\'')) {
+            key = unquote(key_text);
+        } else {
+            auto dot = key_text.rfind('.');
+            if(dot != std::string_view::npos) {
+                if(!key_section.empty())
+                    key_section += '.';
+                key_section += trim(key_text.substr(0, dot));
+                key_text = key_text.substr(dot + 1);
+            }
+            key = std::string(trim(key_text));
+        }
+
+        auto setting = key_section + "." + key;
+        switch(apply(snapshot, key_section, key, value)) {
+        case Assignment::Applied:
+            break;
+        case Assignment::Invalid:
+            report(Console::Level::Error, first_line,
+                   "invalid value for " + setting + ": " + value);
+            break;
+        case Assignment::Unknown:
+            report(Console::Level::Debug, first_line, "unknown setting " + setting);
+            break;
+        }
+    }
+}
+
+// Missing files are skipped, their settings keep the values of the previous file or the defaults.
+// Returns the hash of the file content, 0 for missing files.
+uint64_t parseFile(const std::string& path,
+                   const char* file_name,
+                   bool toml,
+                   Config::Snapshot& snapshot,
+                   std::vector<Diagnostic>& diagnostics) {
+    MappedFile file(path);
+    if(!file.isOpen())
+        return 0;
+    parse(file.view(), file_name, toml, snapshot, diagnostics);
+    return Hash::bytes(file.data(), file.size());
+}
+
+// Parses both files into a new snapshot, publishes it and logs the problems found with the new
+// logging settings
+void load(Snapshots& snaps) {
+    // Taken before parsing, an edit during the load is picked up by the next reload
+    snaps.ini_stamp = FileStamp::of(iniPath());
+    snaps.toml_stamp = FileStamp::of(tomlPath());
+
+    auto next = std::make_unique<Config::Snapshot>();
+    std::vector<Diagnostic> diagnostics;
+    auto ini_hash = parseFile(iniPath(), "ZHM5Randomizer.ini", false, *next, diagnostics);
+    auto toml_hash = parseFile(tomlPath(), "hitman_randomizer.toml", true, *next, diagnostics);
+    next->hash = Hash::combine64(ini_hash, toml_hash);
+
+    snaps.current.store(next.get(), std::memory_order_release);
+    snaps.retired.push_back(std::move(snaps.owner));
+    snaps.owner = std::move(next);
+
+    for(const auto& diagnostic : diagnostics) {
+        if(diagnostic.level == Console::Level::Error)
+            LOG_ERROR("%s\n", diagnostic.text);
+        else
+            LOG_DEBUG("%s\n", diagnostic.text);
+    }
+}
+
+} // namespace
+
+const Config::Snapshot& Config::current() {
+    return *snapshots().current.load(std::memory_order_acquire);
+}
 
-#define LOAD_INI_ENTRY(name, cat, default_) \
-    name = GetPrivateProfileIntA(cat, #name, default_, ini_path.c_str());
-#define LOAD_INI_STRING_ENTRY(name, cat, default_)                                                    \
-    char strbuf_##name[iniStringBufSize];                                                             \
-    GetPrivateProfileString(cat, #name, default_, strbuf_##name, iniStringBufSize, ini_path.c_str()); \
-    Config::##name = std::string(strbuf_##name)
+std::string Config::retailPath(std::string_view name) {
+    return (std::filesystem::path(base_directory) / "Retail" / name).string();
+}
 
+#ifdef _WIN32
 void Config::loadConfig() {
     TCHAR szExeFileName[MAX_PATH];
     GetModuleFileName(NULL, szExeFileName, MAX_PATH);
     std::filesystem::path path(szExeFileName);
-    Config::base_directory = path.parent_path().parent_path().generic_string(); //..\\HITMAN3
+    loadConfig(path.parent_path().parent_path().generic_string()); //..\\HITMAN3
+}
+#endif
 
-    auto ini_path = Config::base_directory + "\\Retail\\ZHM5Randomizer.ini";
+void Config::loadConfig(const std::string& directory) {
+    Config::base_directory = directory;
+    load(snapshots());
+}
 
-    LOAD_INI_STRING_ENTRY(worldInventoryRandomizer, iniMainCategory, "DEFAULT");
-    LOAD_INI_STRING_ENTRY(heroInventoryRandomizer, iniMainCategory, "DEFAULT");
-    LOAD_INI_STRING_ENTRY(npcInventoryRandomizer, iniMainCategory, "DEFAULT");
-    LOAD_INI_STRING_ENTRY(stashInventoryRandomizer, iniMainCategory, "DEFAULT");
-    LOAD_INI_ENTRY(randomizeNPCGrenades, iniMainCategory, 0);
-    LOAD_INI_ENTRY(RNGSeed, iniMainCategory, 0);
+bool Config::reloadIfChanged() {
+    auto& snaps = snapshots();
+    snaps.retired.clear();
+    if(FileStamp::of(iniPath()) == snaps.ini_stamp && FileStamp::of(tomlPath()) == snaps.toml_stamp)
+        return false;
 
-    LOAD_INI_ENTRY(showDebugConsole, "Debug", 0);
-    LOAD_INI_ENTRY(enableDebugLogging, "Debug", 0);
-    LOAD_INI_ENTRY(logToFile, "Debug", 0);
-}
\ No newline at end of file
+    load(snaps);
+    return true;
+}
@@ -1,20 +1,66 @@
 #pragma once
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace Config {
 
+// Directory of the game installation (..\HITMAN3), set by loadConfig
 extern std::string base_directory;
-extern std::string worldInventoryRandomizer;
-extern std::string heroInventoryRandomizer;
-extern std::string npcInventoryRandomizer;
-extern std::string stashInventoryRandomizer;
-extern bool randomizeNPCGrenades;
-extern bool showDebugConsole;
-extern bool enableDebugLogging;
-extern bool logToFile;
-extern int RNGSeed;
-extern std::string randomizationScenario;
 
+// Path of a file or directory in base_directory\Retail, with the separators of the platform
+std::string retailPath(std::string_view name);
+
+// Settings parsed from Retail\ZHM5Randomizer.ini and Retail\hitman_randomizer.toml. Both files
+// use the same sections and keys, values set in the TOML file override those of the ini file.
+// A snapshot is never modified after it has been published, reloads publish a new one instead.
+struct Snapshot {
+    std::string worldInventoryRandomizer = "DEFAULT";
+    std::string heroInventoryRandomizer = "DEFAULT";
+    std::string npcInventoryRandomizer = "DEFAULT";
+    std::string stashInventoryRandomizer = "DEFAULT";
+    bool randomizeNPCGrenades = false;
+    bool showDebugConsole = false;
+    bool enableDebugLogging = false;
+    bool logToFile = false;
+    // Lowest Console::Level that is logged: 0 debug, 1 info, 2 error
+    int logLevel = 0;
+    int RNGSeed = 0;
+    int worldItemMaxRepeats = 0;
+    // World items are replaced by their original item instead of in pool order
+    bool orderIndependentWorldItems = false;
+
+    // Word lists of the CUSTOM world and NPC randomizers
+    std::vector<std::string> customWorldAllowedWords;
+    std::vector<std::string> customWorldIgnoredWords;
+    std::vector<std::string> customNPCAllowedWords;
+    std::vector<std::string> customNPCIgnoredWords;
+
+    // Draw weight multipliers by item category ("pistol", "explosives", ...) and weight overrides
+    // by item id. Items default to the weight given in Repository.json, or 1.
+    std::unordered_map<std::string, double> categoryWeights;
+    std::unordered_map<std::string, double> itemWeights;
+
+    // Hash of the contents of both files, equal for snapshots parsed from the same files
+    uint64_t hash = 0;
+};
+
+// Returns the current snapshot. Snapshots replaced by a reload stay valid until the next reload,
+// don't hold on to the reference beyond that.
+const Snapshot& current();
+
+// Called on DLL attach: determines base_directory, parses the config files and publishes the
+// resulting snapshot.
 void loadConfig();
+
+// Same for tools running outside the game, directory is the game installation
+void loadConfig(const std::string& directory);
+
+// Called on scene load. Parses the config files again only if one of them was created, edited or
+// removed since the current snapshot was parsed, and publishes the result with an atomic pointer
+// swap. Returns true if a new snapshot was published.
+bool reloadIfChanged();
 }; // namespace Config
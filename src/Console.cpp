@@ -1,40 +1,401 @@
-#include <Windows.h>
-#include <sstream>
-#include <iomanip>
-#include <fstream>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 #include "Console.h"
 #include "Config.h"
+#ifdef _WIN32
+#include <Windows.h>
+#endif
 
+//Tools running outside the game already have a console
 void Console::spawn()
 {
+#ifdef _WIN32
 	AllocConsole();
 	FILE* stream;
 	freopen_s(&stream, "CONOUT$", "w", stdout);
+#endif
+}
+
+bool Console::isEnabled(Level level) {
+	const auto& config = Config::current();
+	return config.enableDebugLogging && static_cast<int>(level) >= config.logLevel;
+}
+
+namespace {
+
+//The log file is renamed to ZHM5Randomizer.1.log once it grows beyond this
+constexpr long max_log_file_size = 4 << 20;
+constexpr auto consumer_interval = std::chrono::milliseconds(5);
+//Threads are terminated before DLL_PROCESS_DETACH when the process exits, the background thread
+//may have died holding drain_mutex
+constexpr auto shutdown_timeout = std::chrono::milliseconds(100);
+constexpr uint32_t wrap_marker = ~uint32_t(0);
+
+//Single producer (the owning thread), single consumer (whoever holds drain_mutex). Positions
+//count bytes since the ring was created, records are a 4 byte size followed by the record.
+//A record never wraps around the end of the buffer, the space left there is skipped.
+//A ring is released when its thread exits and handed to the next thread that logs, records the
+//old thread left behind are drained in order before the new ones.
+struct Ring {
+	static constexpr size_t capacity = 1 << 18;
+
+	std::atomic<bool> in_use{ true };
+	std::atomic<size_t> head{ 0 };
+	std::atomic<size_t> tail{ 0 };
+	std::atomic<uint64_t> dropped{ 0 };
+	size_t pending_end = 0;
+	uint8_t data[capacity];
+};
+
+std::mutex rings_mutex;
+std::vector<std::unique_ptr<Ring>> rings;
+std::timed_mutex drain_mutex;
+std::atomic<bool> stopping{ false };
+uint64_t reported_drops = 0;
+FILE* log_file = nullptr;
+
+struct Argument {
+	Console::detail::Tag tag;
+	uint64_t bits;
+	std::string_view string;
+};
+
+class ArgumentReader {
+public:
+	ArgumentReader(const uint8_t* begin, const uint8_t* end) : pos(begin), end(end) {}
+
+	bool next(Argument& arg) {
+		if (pos == end)
+			return false;
+		arg.tag = static_cast<Console::detail::Tag>(*pos++);
+		if (arg.tag == Console::detail::Tag::String) {
+			uint32_t size;
+			memcpy(&size, pos, sizeof(size));
+			arg.string = std::string_view(reinterpret_cast<const char*>(pos + sizeof(size)), size);
+			pos += sizeof(size) + size;
+		} else {
+			memcpy(&arg.bits, pos, sizeof(arg.bits));
+			pos += sizeof(arg.bits);
+		}
+		return true;
+	}
+
+	long long nextInteger() {
+		Argument arg;
+		if (!next(arg))
+			return 0;
+		if (arg.tag == Console::detail::Tag::Float)
+			return static_cast<long long>(asDouble(arg));
+		return static_cast<long long>(arg.bits);
+	}
+
+	static double asDouble(const Argument& arg) {
+		double value;
+		memcpy(&value, &arg.bits, sizeof(value));
+		return value;
+	}
+
+private:
+	const uint8_t* pos;
+	const uint8_t* end;
+};
+
+template <typename... Args>
+void appendFormatted(std::string& out, const char* spec, Args... args) {
+	char buf[256];
+	int n = snprintf(buf, sizeof(buf), spec, args...);
+	if (n < 0)
+		return;
+	if (n < static_cast<int>(sizeof(buf))) {
+		out.append(buf, n);
+	} else {
+		auto offset = out.size();
+		out.resize(offset + n + 1);
+		snprintf(out.data() + offset, n + 1, spec, args...);
+		out.resize(offset + n);
+	}
+}
+
+//printf for arguments that were captured into a record. Each conversion is formatted on its own
+//with a specification rebuilt for the captured argument type.
+void formatRecord(const char* fmt, ArgumentReader& args, std::string& out) {
+	for (const char* c = fmt; *c;) {
+		if (*c != '%') {
+			auto start = c;
+			while (*c && *c != '%')
+				++c;
+			out.append(start, c);
+			continue;
+		}
+		if (c[1] == '%') {
+			out += '%';
+			c += 2;
+			continue;
+		}
+
+		std::string spec = "%";
+		++c;
+		while (*c && strchr("-+ #0", *c))
+			spec += *c++;
+		if (*c == '*') {
+			spec += std::to_string(args.nextInteger());
+			++c;
+		} else {
+			while (*c >= '0' && *c <= '9')
+				spec += *c++;
+		}
+		int precision = -1;
+		if (*c == '.') {
+			++c;
+			if (*c == '*') {
+				precision = static_cast<int>(args.nextInteger());
+				++c;
+			} else {
+				precision = 0;
+				while (*c >= '0' && *c <= '9')
+					precision = precision * 10 + (*c++ - '0');
+			}
+		}
+		while (*c && strchr("hlLjztI", *c)) {
+			if (*c == 'I' && ((c[1] == '3' && c[2] == '2') || (c[1] == '6' && c[2] == '4')))
+				c += 2;
+			++c;
+		}
+		char conversion = *c;
+		if (!conversion)
+			break;
+		++c;
+
+		Argument arg;
+		if (!args.next(arg)) {
+			out += "<?>";
+			continue;
+		}
+		auto precision_spec = precision >= 0 ? "." + std::to_string(precision) : std::string();
+		bool is_string = arg.tag == Console::detail::Tag::String;
+		switch (conversion) {
+		case 'd': case 'i':
+		case 'u': case 'x': case 'X': case 'o':
+			if (is_string) {
+				out += "<?>";
+				break;
+			}
+			spec += precision_spec + "ll" + conversion;
+			if (arg.tag == Console::detail::Tag::Float)
+				appendFormatted(out, spec.c_str(), static_cast<long long>(ArgumentReader::asDouble(arg)));
+			else
+				appendFormatted(out, spec.c_str(), static_cast<long long>(arg.bits));
+			break;
+		case 'c':
+			spec += 'c';
+			appendFormatted(out, spec.c_str(), is_string ? '?' : static_cast<int>(arg.bits));
+			break;
+		case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+			if (is_string) {
+				out += "<?>";
+				break;
+			}
+			spec += precision_spec + conversion;
+			if (arg.tag == Console::detail::Tag::Float)
+				appendFormatted(out, spec.c_str(), ArgumentReader::asDouble(arg));
+			else if (arg.tag == Console::detail::Tag::Signed)
+				appendFormatted(out, spec.c_str(), static_cast<double>(static_cast<int64_t>(arg.bits)));
+			else
+				appendFormatted(out, spec.c_str(), static_cast<double>(arg.bits));
+			break;
+		case 's': {
+			if (!is_string) {
+				out += "<?>";
+				break;
+			}
+			auto length = static_cast<int>(arg.string.size());
+			if (precision >= 0 && precision < length)
+				length = precision;
+			spec += ".*s";
+			appendFormatted(out, spec.c_str(), length, arg.string.data());
+		} break;
+		case 'p':
+			spec += 'p';
+			appendFormatted(out, spec.c_str(), reinterpret_cast<void*>(static_cast<uintptr_t>(arg.bits)));
+			break;
+		default:
+			out += spec + conversion;
+		}
+	}
+}
+
+void formatRecord(const uint8_t* record, uint32_t size, std::string& out) {
+	const char* fmt;
+	memcpy(&fmt, record + 1, sizeof(fmt));
+	ArgumentReader args(record + 1 + sizeof(fmt), record + size);
+	formatRecord(fmt, args, out);
+}
+
+void drainRing(Ring& ring, std::string& out) {
+	auto tail = ring.tail.load(std::memory_order_relaxed);
+	auto head = ring.head.load(std::memory_order_acquire);
+	while (tail != head) {
+		auto offset = tail % Ring::capacity;
+		auto contiguous = Ring::capacity - offset;
+		uint32_t size = wrap_marker;
+		if (contiguous >= sizeof(size))
+			memcpy(&size, ring.data + offset, sizeof(size));
+		if (size == wrap_marker) {
+			tail += contiguous;
+			continue;
+		}
+		formatRecord(ring.data + offset + sizeof(size), size, out);
+		tail += sizeof(size) + size;
+	}
+	ring.tail.store(tail, std::memory_order_release);
 }
 
-//TODO: Implement file logging properly
-void Console::log(const char* fmt, ...) {
-	if (!Config::enableDebugLogging)
+std::string logPath(int generation) {
+	return Config::retailPath(generation ? "ZHM5Randomizer.1.log" : "ZHM5Randomizer.log");
+}
+
+void writeToFile(const std::string& text) {
+	if (!log_file && !(log_file = fopen(logPath(0).c_str(), "ab"))) {
+		fwrite(text.data(), 1, text.size(), stdout);
 		return;
+	}
+	fwrite(text.data(), 1, text.size(), log_file);
+	fflush(log_file);
+
+	if (ftell(log_file) > max_log_file_size) {
+		fclose(log_file);
+		log_file = nullptr;
+		std::error_code ec;
+		std::filesystem::rename(logPath(0), logPath(1), ec);
+	}
+}
+
+void write(const std::string& text) {
+	if (Config::current().logToFile) {
+		writeToFile(text);
+		return;
+	}
+	if (log_file) {
+		fclose(log_file);
+		log_file = nullptr;
+	}
+	fwrite(text.data(), 1, text.size(), stdout);
+	fflush(stdout);
+}
+
+void drainAll() {
+	std::vector<Ring*> snapshot;
+	{
+		std::lock_guard lock(rings_mutex);
+		for (const auto& ring : rings)
+			snapshot.push_back(ring.get());
+	}
+
+	std::string batch;
+	uint64_t drops = 0;
+	for (auto ring : snapshot) {
+		drainRing(*ring, batch);
+		drops += ring->dropped.load(std::memory_order_relaxed);
+	}
+	if (drops != reported_drops) {
+		batch += std::to_string(drops - reported_drops) +
+			" log records dropped, the log buffer was full\n";
+		reported_drops = drops;
+	}
+	if (!batch.empty())
+		write(batch);
+}
+
+void consumerLoop() {
+	for (;;) {
+		{
+			std::lock_guard lock(drain_mutex);
+			if (stopping.load(std::memory_order_relaxed))
+				return;
+			drainAll();
+		}
+		std::this_thread::sleep_for(consumer_interval);
+	}
+}
+
+//Owns the calling thread's ring for the lifetime of the thread
+class RingLease {
+public:
+	RingLease() {
+		std::lock_guard lock(rings_mutex);
+		if (rings.empty())
+			std::thread(consumerLoop).detach();
+		for (const auto& candidate : rings) {
+			bool expected = false;
+			if (candidate->in_use.compare_exchange_strong(expected, true)) {
+				ring = candidate.get();
+				return;
+			}
+		}
+		ring = rings.emplace_back(std::make_unique<Ring>()).get();
+	}
 
-	va_list ap;
-	va_start(ap, fmt);
-	vprintf(fmt, ap);
-
-	//if (Config::logToFile) {
-	//	char buf[256];
-	//	vsprintf_s(buf, fmt, ap);
-
-	//	auto log_path = Config::base_directory + "/Retail/ZHM5Randomizer.log";
-	//	std::ofstream ofs(log_path.c_str(), std::ofstream::out || std::ofstream::app );
-	//	if (!ofs.is_open())
-	//		printf("Failed to open log file: %s\n", log_path.c_str());
-	//	ofs.write(buf, strlen(buf));
-	//	ofs.close();
-
-	//	printf(buf);
-	//}
-	//else {
-	//	vprintf(fmt, ap);
-	//}
+	~RingLease() {
+		ring->in_use.store(false, std::memory_order_release);
+	}
+
+	Ring* ring;
+};
+
+Ring& threadRing() {
+	thread_local RingLease lease;
+	return *lease.ring;
+}
+
+} // namespace
+
+uint8_t* Console::detail::beginRecord(size_t size) {
+	auto& ring = threadRing();
+	auto total = sizeof(uint32_t) + size;
+	auto head = ring.head.load(std::memory_order_relaxed);
+	auto tail = ring.tail.load(std::memory_order_acquire);
+	auto offset = head % Ring::capacity;
+	auto contiguous = Ring::capacity - offset;
+	auto skip = total > contiguous ? contiguous : 0;
+	if (total > Ring::capacity / 2 || head + skip + total - tail > Ring::capacity) {
+		ring.dropped.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+	if (skip && skip >= sizeof(uint32_t))
+		memcpy(ring.data + offset, &wrap_marker, sizeof(wrap_marker));
+
+	auto start = (head + skip) % Ring::capacity;
+	auto record_size = static_cast<uint32_t>(size);
+	memcpy(ring.data + start, &record_size, sizeof(record_size));
+	ring.pending_end = head + skip + total;
+	return ring.data + start + sizeof(record_size);
+}
+
+void Console::detail::commitRecord() {
+	auto& ring = threadRing();
+	ring.head.store(ring.pending_end, std::memory_order_release);
+}
+
+void Console::flush() {
+	std::lock_guard lock(drain_mutex);
+	drainAll();
+}
+
+void Console::shutdown() {
+	std::unique_lock lock(drain_mutex, shutdown_timeout);
+	if (!lock)
+		return;
+	stopping.store(true, std::memory_order_relaxed);
+	drainAll();
+	if (log_file) {
+		fclose(log_file);
+		log_file = nullptr;
+	}
 }
@@ -1,8 +1,136 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
 
+//Logging is asynchronous: a call copies its format string pointer and its arguments into a
+//binary record in a ring buffer owned by the calling thread, a background thread formats the
+//records and writes them in batches to the console or to Retail/ZHM5Randomizer.log.
+//Use the LOG_* macros, their arguments are only evaluated if the level is enabled. Format
+//strings must be string literals, they are read when the record is formatted. Supported are the
+//printf conversions d i u x X o c s p f e g a with the usual flags, widths and precisions
+//(including *); length modifiers are accepted and ignored. %s takes C strings, std::string and
+//std::string_view, all copied into the record.
+//Building with DISABLE_LOGGING removes all logging.
 namespace Console
 {
+	enum class Level : uint8_t {
+		Debug,
+		Info,
+		Error,
+	};
+
 	void spawn();
-	void log(const char* fmt, ...);
+
+	//Enabled by the enableDebugLogging setting, from the logLevel setting up
+	bool isEnabled(Level level);
+	//Formats and writes all pending records on the calling thread
+	void flush();
+	//Called on DLL_PROCESS_DETACH: stops the background thread, writes all pending records and
+	//closes the log file. Records logged afterwards are only written by an explicit flush().
+	void shutdown();
+
+	namespace detail {
+		enum class Tag : uint8_t {
+			Signed,
+			Unsigned,
+			Float,
+			Pointer,
+			String,
+		};
+
+		//Reserves size bytes in the calling thread's ring, nullptr if the ring is full
+		uint8_t* beginRecord(size_t size);
+		void commitRecord();
+
+		inline std::string_view asString(const char* s) {
+			return s ? std::string_view(s) : std::string_view("(null)");
+		}
+		inline std::string_view asString(const std::string& s) { return s; }
+		inline std::string_view asString(std::string_view s) { return s; }
+
+		template <typename T>
+		constexpr bool is_string = std::is_same_v<std::decay_t<T>, const char*> ||
+		                           std::is_same_v<std::decay_t<T>, char*> ||
+		                           std::is_same_v<std::decay_t<T>, std::string> ||
+		                           std::is_same_v<std::decay_t<T>, std::string_view>;
+
+		template <typename T>
+		size_t argumentSize(const T& arg) {
+			if constexpr (is_string<T>)
+				return 1 + sizeof(uint32_t) + asString(arg).size();
+			else
+				return 1 + sizeof(uint64_t);
+		}
+
+		template <typename T>
+		uint8_t* writeArgument(uint8_t* out, const T& arg) {
+			using U = std::decay_t<T>;
+			uint64_t bits;
+			if constexpr (is_string<T>) {
+				auto s = asString(arg);
+				auto size = static_cast<uint32_t>(s.size());
+				*out++ = static_cast<uint8_t>(Tag::String);
+				memcpy(out, &size, sizeof(size));
+				memcpy(out + sizeof(size), s.data(), size);
+				return out + sizeof(size) + size;
+			} else if constexpr (std::is_floating_point_v<U>) {
+				double value = arg;
+				memcpy(&bits, &value, sizeof(bits));
+				*out++ = static_cast<uint8_t>(Tag::Float);
+			} else if constexpr (std::is_pointer_v<U>) {
+				bits = reinterpret_cast<uintptr_t>(arg);
+				*out++ = static_cast<uint8_t>(Tag::Pointer);
+			} else if constexpr (std::is_enum_v<U>) {
+				bits = static_cast<uint64_t>(arg);
+				*out++ = static_cast<uint8_t>(Tag::Unsigned);
+			} else {
+				static_assert(std::is_integral_v<U>, "Console: unsupported log argument type");
+				if constexpr (std::is_signed_v<U>) {
+					int64_t value = arg;
+					memcpy(&bits, &value, sizeof(bits));
+					*out++ = static_cast<uint8_t>(Tag::Signed);
+				} else {
+					bits = arg;
+					*out++ = static_cast<uint8_t>(Tag::Unsigned);
+				}
+			}
+			memcpy(out, &bits, sizeof(bits));
+			return out + sizeof(bits);
+		}
+
+		//Record layout: level, format string pointer, then a tag and a payload per argument
+		template <typename... Args>
+		void write(Level level, const char* fmt, const Args&... args) {
+			auto size = 1 + sizeof(fmt) + (size_t(0) + ... + argumentSize(args));
+			auto out = beginRecord(size);
+			if (!out)
+				return;
+			*out++ = static_cast<uint8_t>(level);
+			memcpy(out, &fmt, sizeof(fmt));
+			out += sizeof(fmt);
+			((out = writeArgument(out, args)), ...);
+			commitRecord();
+			//Errors usually precede a throw, they are written before the caller continues
+			if (level == Level::Error)
+				flush();
+		}
+	}
 };
 
+#ifdef DISABLE_LOGGING
+#define CONSOLE_LOG(level, ...) ((void)0)
+#else
+#define CONSOLE_LOG(level, ...)                                \
+	do {                                                       \
+		if (Console::isEnabled(level))                         \
+			Console::detail::write(level, __VA_ARGS__);         \
+	} while (0)
+#endif
+
+#define LOG_DEBUG(...) CONSOLE_LOG(Console::Level::Debug, __VA_ARGS__)
+#define LOG_INFO(...) CONSOLE_LOG(Console::Level::Info, __VA_ARGS__)
+#define LOG_ERROR(...) CONSOLE_LOG(Console::Level::Error, __VA_ARGS__)
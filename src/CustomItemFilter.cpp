@@ -0,0 +1,43 @@
+#include "CustomItemFilter.h"
+#include "AhoCorasick.h"
+#include "Console.h"
+#include "Repository.h"
+
+constexpr uint8_t allowed_flag = 1;
+constexpr uint8_t ignored_flag = 2;
+
+const CandidateSet& CustomItemFilter::get(RandomDrawRepository& repo,
+                                          const std::vector<std::string>& allowed_words,
+                                          const std::vector<std::string>& ignored_words) {
+    if(!candidates || repo.getGeneration() != compiled_generation ||
+       allowed_words != compiled_allowed_words || ignored_words != compiled_ignored_words) {
+        compiled_allowed_words = allowed_words;
+        compiled_ignored_words = ignored_words;
+        compile(repo);
+    }
+    return *candidates;
+}
+
+void CustomItemFilter::compile(RandomDrawRepository& repo) {
+    AhoCorasick matcher;
+    for(const auto& word : compiled_allowed_words)
+        matcher.addPattern(word, allowed_flag);
+    for(const auto& word : compiled_ignored_words)
+        matcher.addPattern(word, ignored_flag);
+    matcher.compile();
+
+    auto required_flags = compiled_allowed_words.empty() ? 0 : allowed_flag;
+
+    ItemBitset allowed(repo.size());
+    for(const auto& handle : repo.index().all().handles) {
+        const auto& item = repo.getItem(handle);
+        auto flags = matcher.scan(item.string()) | matcher.scan(item.getTypeName());
+        if((flags & required_flags) == required_flags && !(flags & ignored_flag))
+            allowed.set(handle);
+    }
+
+    candidates = std::make_unique<CandidateSet>(repo.index().fromBits(allowed));
+    compiled_generation = repo.getGeneration();
+    LOG_INFO("CustomItemFilter: %d of %d items allowed\n", static_cast<int>(candidates->size()),
+             static_cast<int>(repo.index().all().size()));
+}
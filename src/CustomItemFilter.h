@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ItemIndex.h"
+
+class RandomDrawRepository;
+
+// Item filter of the CUSTOM randomisation mode. An item passes if its name or category contains
+// one of the allowed words and none of the ignored words. The word lists are compiled into a
+// single Aho-Corasick automaton which is run over the repository once; the resulting candidate
+// set is reused until the word lists or the repository change.
+class CustomItemFilter {
+public:
+    // Returns the items matching the given word lists. An empty allow list allows every item.
+    const CandidateSet& get(RandomDrawRepository& repo,
+                            const std::vector<std::string>& allowed_words,
+                            const std::vector<std::string>& ignored_words);
+
+private:
+    std::vector<std::string> compiled_allowed_words;
+    std::vector<std::string> compiled_ignored_words;
+    std::unique_ptr<CandidateSet> candidates;
+    uint32_t compiled_generation = 0;
+
+    void compile(RandomDrawRepository& repo);
+};
@@ -1,62 +1,158 @@
 #include "DefaultItemPool.h"
 #include "Repository.h"
-#include "..\thirdparty\json.hpp"
 #include "Console.h"
+#include "Hash.h"
+#include <algorithm>
 
-DefaultItemPool::DefaultItemPool(json& json) {
-	for (json::iterator item = json.begin(); item != json.end(); ++item) {
-		RepositoryID id(item.value().get<std::string>());
+DefaultItemPool::DefaultItemPool(const std::vector<RepositoryID>& pool_ids)
+	: content_hash(Hash::bytes(pool_ids.data(), pool_ids.size() * sizeof(RepositoryID))) {
+	const auto& repo = RandomDrawRepository::inst();
+	ItemHandle previous = 0;
+	for (const auto& id : pool_ids) {
+		auto handle = repo.getHandle(id);
+		if (!handle)
+			continue;
 
-		if (RandomDrawRepository::inst().contains(id))
-			ids.push_back(id);
+		auto delta = static_cast<int64_t>(*handle) - static_cast<int64_t>(previous);
+		auto zigzag = static_cast<uint64_t>((delta << 1) ^ (delta >> 63));
+		for (; zigzag >= 0x80; zigzag >>= 7)
+			encoded_handles.push_back(static_cast<uint8_t>(zigzag | 0x80));
+		encoded_handles.push_back(static_cast<uint8_t>(zigzag));
+		previous = *handle;
+		++count;
+		handle_counts.emplace_back(*handle, 1);
+	}
+	encoded_handles.shrink_to_fit();
+
+	std::sort(handle_counts.begin(), handle_counts.end());
+	size_t unique = 0;
+	for (const auto& entry : handle_counts) {
+		if (unique > 0 && handle_counts[unique - 1].first == entry.first)
+			++handle_counts[unique - 1].second;
+		else
+			handle_counts[unique++] = entry;
+	}
+	handle_counts.resize(unique);
+	handle_counts.shrink_to_fit();
+
+	computeStats(repo);
+}
+
+template <typename Fn>
+void DefaultItemPool::forEachHandle(Fn&& fn) const {
+	ItemHandle handle = 0;
+	size_t pos = 0;
+	for (uint32_t i = 0; i < count; ++i) {
+		uint64_t zigzag = 0;
+		for (int shift = 0;; shift += 7) {
+			auto byte = encoded_handles[pos++];
+			zigzag |= static_cast<uint64_t>(byte & 0x7f) << shift;
+			if (!(byte & 0x80))
+				break;
+		}
+		auto delta = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+		handle = static_cast<ItemHandle>(handle + delta);
+		fn(static_cast<int>(i), handle);
 	}
 }
 
+void DefaultItemPool::computeStats(const RandomDrawRepository& repo) const {
+	stats = Stats();
+	stats.generation = repo.getGeneration();
+	//Items can disappear from the repository when it is reloaded, those no longer match anything
+	forEachHandle([&](int, ItemHandle handle) {
+		if (repo.isLive(handle))
+			++stats.icon_counts[static_cast<size_t>(repo.getItem(handle).getType())];
+	});
+	//Queried by the world inventory randomisation on every scene load
+	getPosition(&Item::isEssential);
+	getPosition(&Item::isWeapon);
+}
+
+const DefaultItemPool::Stats& DefaultItemPool::currentStats() const {
+	const auto& repo = RandomDrawRepository::inst();
+	if (stats.generation != repo.getGeneration())
+		computeStats(repo);
+	return stats;
+}
+
 size_t DefaultItemPool::size() const {
-	return ids.size();
+	return count;
 }
 
-void DefaultItemPool::get(std::vector<const RepositoryID*>& out, bool(Item::* fn)()const) const {
-	auto repo = RandomDrawRepository::inst();
-	for (const auto& id : ids) {
-		if ((repo.getItem(id)->*fn)())
-			out.push_back(&id);
-	}
+uint64_t DefaultItemPool::contentHash() const {
+	return content_hash;
+}
+
+size_t DefaultItemPool::footprint() const {
+	return sizeof(*this) + encoded_handles.capacity() +
+		handle_counts.capacity() * sizeof(handle_counts[0]);
+}
+
+void DefaultItemPool::getHandles(std::span<ItemHandle> out) const {
+	forEachHandle([&](int pos, ItemHandle handle) {
+		out[pos] = handle;
+	});
 }
-void DefaultItemPool::getPosition(std::vector<int>& out, bool(Item::* fn)()const) const {
-	auto repo = RandomDrawRepository::inst();
-	int cnt = 0;
-	for (const auto& id : ids) {
-		if ((repo.getItem(id)->*fn)())
-			out.push_back(cnt);
-		++cnt;
+
+void DefaultItemPool::get(std::span<const RepositoryID*> out, bool(Item::* fn)()const) const {
+	const auto& repo = RandomDrawRepository::inst();
+	auto positions = getPosition(fn);
+	size_t written = 0;
+	forEachHandle([&](int pos, ItemHandle handle) {
+		if (written < positions.size() && positions[written] == pos)
+			out[written++] = repo.getStablePointer(handle);
+	});
+}
+
+std::span<const int> DefaultItemPool::getPosition(bool(Item::* fn)()const) const {
+	currentStats();
+	for (const auto& [predicate, positions] : stats.positions) {
+		if (predicate == fn)
+			return positions;
 	}
+
+	const auto& repo = RandomDrawRepository::inst();
+	std::vector<int> positions;
+	forEachHandle([&](int pos, ItemHandle handle) {
+		if (repo.isLive(handle) && (repo.getItem(handle).*fn)())
+			positions.push_back(pos);
+	});
+	//Moving the vector keeps its buffer, so spans of other predicates stay valid when one is added.
+	//All of them are freed when the stats are recomputed after a repository reload.
+	return stats.positions.emplace_back(fn, std::move(positions)).second;
 }
 
 size_t DefaultItemPool::getCount(bool(Item::* fn)()const) const {
-	auto repo = RandomDrawRepository::inst();
-	int cnt = 0;
-	for (const auto& id : ids) {
-		if ((repo.getItem(id)->*fn)())
-			++cnt;
-	}
-	return cnt;
+	return getPosition(fn).size();
+}
+
+size_t DefaultItemPool::getCount(ICON icon) const {
+	return currentStats().icon_counts[static_cast<size_t>(icon)];
 }
 
 size_t DefaultItemPool::getCount(const RepositoryID& id) const {
-	return std::count(ids.begin(), ids.end(), id);
+	//Handles of removed items are still known to the repository, but getHandle doesn't return them
+	auto handle = RandomDrawRepository::inst().getHandle(id);
+	if (!handle)
+		return 0;
+	auto it = std::lower_bound(handle_counts.begin(), handle_counts.end(),
+		std::make_pair(*handle, uint32_t(0)));
+	return it != handle_counts.end() && it->first == *handle ? it->second : 0;
 }
 
 void DefaultItemPool::print() const {
-	auto repo = RandomDrawRepository::inst();
-	Console::log("DefaultPool report:\n");
-	for (const auto& id : ids) {
-		Console::log("\t");
-		repo.getItem(id)->print();
-	}
+	const auto& repo = RandomDrawRepository::inst();
+	LOG_INFO("DefaultPool report:\n");
+	forEachHandle([&](int, ItemHandle handle) {
+		LOG_INFO("\t");
+		if (repo.isLive(handle))
+			repo.getItem(handle).print();
+		else
+			LOG_INFO("%s (not in repository)\n", repo.getStablePointer(handle)->text().c_str());
+	});
 }
 
-
 //void DefaultItemPool::get(std::vector<RepositoryID*>& out, std::function<bool(const Item&)> fn) {
 //	auto& repo = Repository::inst();
 //	for (const auto& id : ids) {
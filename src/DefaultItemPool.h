@@ -1,31 +1,67 @@
 #pragma once
+#include <array>
+#include <cstdint>
+#include <span>
+#include <utility>
 #include <vector>
 #include <functional>
-#include "..\thirdparty\json.hpp"
+#include "Item.h"
+#include "ItemIndex.h"
 #include "RepositoryID.h"
 
-using json = nlohmann::json;
-
-class Item;
+class RandomDrawRepository;
 
 //Represents a list of items distributed in a level of a given Senario. Default item pools are nessecary
 //for the generation of suitable randomized item pools. 
 class DefaultItemPool
 {
 private:
-	std::vector<RepositoryID> ids;
+	using Predicate = bool(Item::*)()const;
+
+	//Per category histogram and predicate positions of the pool, computed against one repository
+	//snapshot and recomputed when the repository is reloaded
+	struct Stats {
+		uint32_t generation = 0;
+		std::array<uint32_t, static_cast<size_t>(ICON::SMG) + 1> icon_counts{};
+		std::vector<std::pair<Predicate, std::vector<int>>> positions;
+	};
+
+	//Repository handles in pool order, each stored as the zigzag varint of its difference to the
+	//previous handle. Handles stay valid across repository reloads.
+	std::vector<uint8_t> encoded_handles;
+	uint32_t count = 0;
+	//Occurrences of each handle, sorted by handle
+	std::vector<std::pair<ItemHandle, uint32_t>> handle_counts;
+	uint64_t content_hash;
+	mutable Stats stats;
+
+	template <typename Fn>
+	void forEachHandle(Fn&& fn) const;
+	void computeStats(const RandomDrawRepository& repo) const;
+	const Stats& currentStats() const;
 	
 public:
-	DefaultItemPool(json& json);
+	//Ids that aren't in the repository are dropped
+	DefaultItemPool(const std::vector<RepositoryID>& pool_ids);
 
 	size_t size() const;
+	//Bytes held by the pool, not counting lazily computed positions
+	size_t footprint() const;
+	//Hash of the ids the pool was loaded from, in pool order
+	uint64_t contentHash() const;
 
-	void get(std::vector<const RepositoryID*>& out, bool(Item::* fn)()const) const;
-	void getPosition(std::vector<int>& out, bool(Item::* fn)()const) const;
+	//Writes the repository handle of every position to out, which must have room for size() handles
+	void getHandles(std::span<ItemHandle> out) const;
+	//Writes the items matching fn to out, which must have room for getCount(fn) items
+	void get(std::span<const RepositoryID*> out, bool(Item::* fn)()const) const;
+	//Positions of the items matching fn, in pool order. Positions of predicates other than
+	//isEssential and isWeapon are computed on first use. The span is valid until the next
+	//repository reload, the first call after it recomputes the positions.
+	std::span<const int> getPosition(bool(Item::* fn)()const) const;
 	size_t getCount(bool(Item::* fn)()const) const;
+	size_t getCount(ICON icon) const;
 	size_t getCount(const RepositoryID&) const;
 
 	void print() const;
 	
 };
-
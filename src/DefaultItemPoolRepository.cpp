@@ -1,22 +1,255 @@
 #include "DefaultItemPoolRepository.h"
+#include "Console.h"
+#include "Repository.h"
+#include "RepositoryID.h"
+#include "../thirdparty/json.hpp"
+#include <cstdio>
+#include <filesystem>
 #include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
-DefaultItemPoolRepository::DefaultItemPoolRepository(std::string path) {
+using json = nlohmann::json;
 
-    std::ifstream ifs(path);
+namespace {
 
-    json repository_json;
-    ifs >> repository_json;
-    ifs.close();
+// Minimal scanner over the structure of DefaultItemPools.json:
+// { "<scenario hex>": [ "<guid>", ... ], ... }
+// Scenario keys and ids never contain escapes, so strings end at the next quote.
+class PoolScanner {
+public:
+    PoolScanner(std::string_view text, size_t pos) : text(text), pos(pos) {
+    }
+
+    size_t position() const {
+        return pos;
+    }
+
+    bool atEnd() {
+        skipWhitespace();
+        return pos == text.size();
+    }
+
+    // Consumes c if it is the next non-whitespace character
+    bool accept(char c) {
+        skipWhitespace();
+        if(pos == text.size() || text[pos] != c)
+            return false;
+        ++pos;
+        return true;
+    }
+
+    void expect(char c) {
+        if(!accept(c))
+            fail("unexpected character");
+    }
+
+    std::string_view string() {
+        expect('"');
+        auto end = text.find('"', pos);
+        if(end == std::string_view::npos)
+            fail("unterminated string");
+        auto value = text.substr(pos, end - pos);
+        pos = end + 1;
+        return value;
+    }
+
+    // Calls fn for every element of a flat array of strings
+    template <typename Fn>
+    void forEachString(Fn&& fn) {
+        expect('[');
+        if(accept(']'))
+            return;
+        do
+            fn(string());
+        while(accept(','));
+        expect(']');
+    }
+
+    [[noreturn]] void fail(const char* what) {
+        LOG_ERROR("Failed to load DefaultItemPools.json: %s at offset %zu\n", what, pos);
+        throw "DefaultItemPoolRepository: default item pools could not be loaded";
+    }
+
+private:
+    std::string_view text;
+    size_t pos;
+
+    void skipWhitespace() {
+        while(pos < text.size() &&
+              (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r'))
+            ++pos;
+    }
+};
+
+} // namespace
+
+DefaultItemPoolRepository::DefaultItemPoolRepository(std::string path, std::string migrations_path_)
+: file(path), migrations_path(std::move(migrations_path_)) {
+    if(!file.isOpen()) {
+        LOG_ERROR("Failed to load %s\n", path.c_str());
+        throw "DefaultItemPoolRepository: default item pools could not be loaded";
+    }
+    buildIndex(file.view());
+    loadMigrations();
+    LOG_INFO("DefaultItemPoolRepository: %zu scenarios indexed\n", scenarioCount());
+}
+
+void DefaultItemPoolRepository::buildIndex(std::string_view text) {
+    PoolScanner scanner(text, 0);
+    scanner.expect('{');
+    if(!scanner.accept('}')) {
+        do {
+            auto key = std::string(scanner.string());
+            scanner.expect(':');
+            auto offset = static_cast<uint32_t>(scanner.position());
+            scanner.forEachString([](std::string_view) {});
+
+            Scenario scen;
+            try {
+                scen = std::stoull(key, nullptr, 0x10);
+            } catch(const std::exception&) {
+                scanner.fail("invalid scenario key");
+            }
+            item_pools[scen] = Entry{ offset, nullptr };
+        } while(scanner.accept(','));
+        scanner.expect('}');
+    }
+    if(!scanner.atEnd())
+        scanner.fail("trailing characters");
+}
+
+size_t DefaultItemPoolRepository::scenarioCount() const {
+    return item_pools.size();
+}
+
+void DefaultItemPoolRepository::dropStalePools() {
+    auto current = RandomDrawRepository::inst().getGeneration();
+    if(current == generation)
+        return;
 
-    for(const auto& it : repository_json.items()) {
-        auto key = std::stoull(it.key(), nullptr, 0x10);
-        item_pools[key] = std::make_unique<DefaultItemPool>(it.value());
+    retired.clear();
+    size_t dropped = 0;
+    for(auto& [scen, entry] : item_pools) {
+        if(entry.pool) {
+            retired.push_back(std::move(entry.pool));
+            ++dropped;
+        }
     }
+    generation = current;
+    if(dropped)
+        LOG_DEBUG("DefaultItemPoolRepository: repository reloaded, %zu pools dropped\n", dropped);
 }
 
 DefaultItemPool* DefaultItemPoolRepository::getDefaultPool(Scenario scen) {
-    if(item_pools.count(scen))
-        return item_pools.at(scen).get();
-    return nullptr;
-}
\ No newline at end of file
+    dropStalePools();
+    auto it = item_pools.find(scen);
+    if(it == item_pools.end())
+        return nullptr;
+
+    auto& entry = it->second;
+    if(!entry.pool) {
+        // The structure was validated by the index, only the ids themselves are left to check.
+        // Called from the scene load hook, so a bad pool must not throw into the game: it is
+        // dropped and the scenario is treated as having no default pool.
+        try {
+            PoolScanner scanner(file.view(), entry.offset);
+            std::vector<RepositoryID> ids;
+            scanner.forEachString([&](std::string_view text) {
+                auto id = RepositoryID::parse(text);
+                if(!id)
+                    scanner.fail("invalid repository id");
+                ids.push_back(*id);
+            });
+            entry.pool = std::make_unique<DefaultItemPool>(ids);
+        } catch(const char* error) {
+            LOG_ERROR("DefaultItemPoolRepository: dropping pool of scenario %016llX: %s\n",
+                      static_cast<unsigned long long>(scen), error);
+            item_pools.erase(it);
+            return nullptr;
+        }
+        LOG_DEBUG("DefaultItemPoolRepository: scenario %016llX decoded, %zu items in %zu bytes\n",
+                  static_cast<unsigned long long>(scen), entry.pool->size(),
+                  entry.pool->footprint());
+    }
+    return entry.pool.get();
+}
+
+DefaultItemPool* DefaultItemPoolRepository::getDefaultPool(const ScenarioKeys& keys) {
+    if(!item_pools.contains(keys.stable) && item_pools.contains(keys.legacy)) {
+        migrate(keys.legacy, keys.stable);
+        LOG_INFO("DefaultItemPoolRepository: scenario %016llX migrated to %016llX\n",
+                 static_cast<unsigned long long>(keys.legacy),
+                 static_cast<unsigned long long>(keys.stable));
+        saveMigrations();
+    }
+    return getDefaultPool(keys.stable);
+}
+
+void DefaultItemPoolRepository::migrate(Scenario legacy, Scenario stable) {
+    auto node = item_pools.extract(legacy);
+    node.key() = stable;
+    item_pools.insert(std::move(node));
+    migrations.emplace_back(legacy, stable);
+}
+
+void DefaultItemPoolRepository::loadMigrations() {
+    if(migrations_path.empty())
+        return;
+    MappedFile migrations_file(migrations_path);
+    if(!migrations_file.isOpen())
+        return;
+
+    auto doc = json::parse(migrations_file.view(), nullptr, false);
+    if(!doc.is_object()) {
+        LOG_ERROR("DefaultItemPoolRepository: %s is not valid, ignoring it\n",
+                  migrations_path.c_str());
+        return;
+    }
+    for(const auto& [legacy_text, stable_json] : doc.items()) {
+        if(!stable_json.is_string())
+            continue;
+        Scenario legacy, stable;
+        try {
+            legacy = std::stoull(legacy_text, nullptr, 0x10);
+            stable = std::stoull(stable_json.get<std::string>(), nullptr, 0x10);
+        } catch(const std::exception&) {
+            continue;
+        }
+        if(!item_pools.contains(stable) && item_pools.contains(legacy))
+            migrate(legacy, stable);
+        else if(!item_pools.contains(legacy))
+            migrations.emplace_back(legacy, stable); // pool file already keyed by the stable hash
+    }
+}
+
+void DefaultItemPoolRepository::saveMigrations() const {
+    if(migrations_path.empty())
+        return;
+
+    json doc = json::object();
+    char legacy[17], stable[17];
+    for(const auto& migration : migrations) {
+        snprintf(legacy, sizeof(legacy), "%016llX",
+                 static_cast<unsigned long long>(migration.first));
+        snprintf(stable, sizeof(stable), "%016llX",
+                 static_cast<unsigned long long>(migration.second));
+        doc[legacy] = stable;
+    }
+
+    auto temp_path = migrations_path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::trunc);
+        out << doc.dump(1, '\t');
+        if(!out) {
+            LOG_ERROR("DefaultItemPoolRepository: could not write %s\n", temp_path.c_str());
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp_path, migrations_path, ec);
+    if(ec)
+        LOG_ERROR("DefaultItemPoolRepository: could not write %s: %s\n", migrations_path.c_str(),
+                  ec.message().c_str());
+}
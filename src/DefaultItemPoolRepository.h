@@ -1,19 +1,56 @@
 #pragma once
+#include <cstdint>
 #include <unordered_map>
 #include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
 #include "DefaultItemPool.h"
+#include "MappedFile.h"
 #include "Scenario.h"
 
 
+//Loads DefaultItemPools.json lazily. On construction only the byte offset of every scenario's
+//pool is indexed, a pool is decoded on the first request for its scenario and cached. Pools keep
+//only the ids known to the repository they were decoded with, so the cache is dropped when the
+//repository is reloaded and pools are decoded again from their offsets.
 class DefaultItemPoolRepository
 {
 private:
-	std::unordered_map<Scenario, std::unique_ptr<DefaultItemPool>> item_pools;
+	struct Entry {
+		uint32_t offset; //of the pool's array in the file
+		std::unique_ptr<DefaultItemPool> pool;
+	};
+
+	MappedFile file;
+	std::unordered_map<Scenario, Entry> item_pools;
+	//Repository generation the cached pools were decoded with
+	uint32_t generation = 0;
+	//Pools dropped at the last reload, the randomizers of the previous scene may still use them
+	std::vector<std::unique_ptr<DefaultItemPool>> retired;
+	//Legacy key -> stable key of every pool that was found by its legacy key
+	std::vector<std::pair<Scenario, Scenario>> migrations;
+	std::string migrations_path;
+
+	void buildIndex(std::string_view text);
+	void loadMigrations();
+	void saveMigrations() const;
+	void migrate(Scenario legacy, Scenario stable);
+	void dropStalePools();
 
 public:
-	DefaultItemPoolRepository(std::string path);
+	//Migrations of pool keys from the legacy to the stable scenario hash are kept in the JSON
+	//file at migrations_path, { "<legacy key>": "<stable key>" }, so offline tools can translate
+	//the keys of existing pool files. Known migrations are applied on load. Without a path
+	//migrations are only kept in memory.
+	explicit DefaultItemPoolRepository(std::string path, std::string migrations_path = "");
 
+	size_t scenarioCount() const;
+	//The pool stays valid until the second repository reload after the call
 	DefaultItemPool* getDefaultPool(Scenario);
+	//Looks up the pool by the stable key, falling back to the legacy key of pool files written
+	//before the stable hash. A pool found by its legacy key is moved to the stable key and the
+	//migration is saved.
+	DefaultItemPool* getDefaultPool(const ScenarioKeys&);
 
 };
-
@@ -0,0 +1,71 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+// Perfect hash from strings to enum values, built at compile time. The constructor searches for
+// a seed that places every name in its own slot of a power of two table; a lookup hashes the
+// input once and compares it with the single name stored in its slot, so unknown names are
+// detected instead of being mapped to a default.
+template <typename Enum, size_t N>
+class EnumMap {
+public:
+    using Entry = std::pair<std::string_view, Enum>;
+
+    constexpr explicit EnumMap(const Entry (&entries)[N]) {
+        for(seed = 0; seed < max_seed; ++seed)
+            if(tryBuild(entries))
+                return;
+        throw "EnumMap: no perfect hash seed found, duplicate names?";
+    }
+
+    constexpr std::optional<Enum> find(std::string_view name) const {
+        const auto& slot = slots[index(name, seed)];
+        if(!slot.used || slot.name != name)
+            return std::nullopt;
+        return slot.value;
+    }
+
+private:
+    static constexpr size_t table_size = std::bit_ceil(N * 2);
+    static constexpr uint32_t max_seed = 1 << 16;
+
+    struct Slot {
+        std::string_view name;
+        Enum value{};
+        bool used = false;
+    };
+
+    Slot slots[table_size]{};
+    uint32_t seed = 0;
+
+    // FNV-1a over the name, seeded so the constructor can try different placements
+    static constexpr size_t index(std::string_view name, uint32_t seed) {
+        uint64_t hash = 0xcbf29ce484222325 ^ (seed * 0x9e3779b97f4a7c15);
+        for(auto c : name) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 0x100000001b3;
+        }
+        return static_cast<size_t>((hash ^ (hash >> 32)) & (table_size - 1));
+    }
+
+    constexpr bool tryBuild(const Entry (&entries)[N]) {
+        for(auto& slot : slots)
+            slot = Slot{};
+        for(const auto& [name, value] : entries) {
+            auto& slot = slots[index(name, seed)];
+            if(slot.used)
+                return false;
+            slot = Slot{ name, value, true };
+        }
+        return true;
+    }
+};
+
+template <typename Enum, size_t N>
+consteval EnumMap<Enum, N> makeEnumMap(const std::pair<std::string_view, Enum> (&entries)[N]) {
+    return EnumMap<Enum, N>(entries);
+}
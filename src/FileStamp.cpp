@@ -0,0 +1,10 @@
+#include "FileStamp.h"
+#include <filesystem>
+
+FileStamp FileStamp::of(const std::string& path) {
+    std::error_code ec;
+    FileStamp stamp;
+    stamp.mtime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    stamp.size = std::filesystem::file_size(path, ec);
+    return stamp;
+}
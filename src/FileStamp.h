@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Size and modification time of a data file, compared on scene load to detect edits
+struct FileStamp {
+    int64_t mtime = 0;
+    uintmax_t size = 0;
+
+    static FileStamp of(const std::string& path);
+    bool operator==(const FileStamp&) const = default;
+};
@@ -0,0 +1,151 @@
+#include "Guid.h"
+#include <cstring>
+// GUID_PARSE_SCALAR selects the scalar loops on SSE2 targets too, for testing them
+#if (defined(_M_X64) || defined(__SSE2__)) && !defined(GUID_PARSE_SCALAR)
+#include <emmintrin.h>
+#define GUID_PARSE_SSE2
+#endif
+
+namespace {
+
+constexpr size_t guid_length = GuidText::length;
+
+#ifdef GUID_PARSE_SSE2
+// Converts 16 hex characters to their values. Bit i of the returned mask is set if character i
+// isn't a hex digit.
+uint32_t hexToNibbles(__m128i chars, __m128i& nibbles) {
+    auto digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    auto letter = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    auto is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    auto is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+    nibbles = _mm_or_si128(_mm_and_si128(is_digit, digit),
+                           _mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+    return ~_mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)) & 0xffff;
+}
+
+// Decodes all 36 characters with three overlapping 16 byte loads (0-15, 16-31, 20-35). The
+// only non hex characters allowed are the dashes at 8, 13, 18 and 23.
+bool toNibbles(const char* text, uint8_t (&n)[guid_length]) {
+    auto load = [text](size_t offset) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + offset));
+    };
+    __m128i lo, mid, hi;
+    auto bad_lo = hexToNibbles(load(0), lo);
+    auto bad_mid = hexToNibbles(load(16), mid);
+    auto bad_hi = hexToNibbles(load(20), hi);
+    if(bad_lo != ((1u << 8) | (1u << 13)) ||
+       bad_mid != ((1u << (18 - 16)) | (1u << (23 - 16))) || bad_hi != (1u << (23 - 20)))
+        return false;
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(n), lo);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(n + 16), mid);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(n + 20), hi);
+    return true;
+}
+#else
+bool toNibbles(const char* text, uint8_t (&n)[guid_length]) {
+    for(size_t i = 0; i < guid_length; ++i) {
+        auto c = static_cast<uint8_t>(text[i]);
+        if(i == 8 || i == 13 || i == 18 || i == 23)
+            continue;
+        if(c >= '0' && c <= '9')
+            n[i] = c - '0';
+        else if((c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+            n[i] = (c | 0x20) - 'a' + 10;
+        else
+            return false;
+    }
+    return true;
+}
+#endif
+
+// Writes the 16 bytes of the id in the order they appear in the text form (the first three
+// fields are stored little endian but printed most significant byte first)
+void textOrderBytes(const Guid& id, uint8_t (&bytes)[16]) {
+    for(int i = 0; i < 4; ++i)
+        bytes[i] = static_cast<uint8_t>(id.Data1 >> (24 - 8 * i));
+    bytes[4] = static_cast<uint8_t>(id.Data2 >> 8);
+    bytes[5] = static_cast<uint8_t>(id.Data2);
+    bytes[6] = static_cast<uint8_t>(id.Data3 >> 8);
+    bytes[7] = static_cast<uint8_t>(id.Data3);
+    memcpy(bytes + 8, id.Data4, 8);
+}
+
+#ifdef GUID_PARSE_SSE2
+// Converts 16 bytes into 32 lowercase hex digits, high nibble first
+void bytesToHex(const uint8_t (&bytes)[16], char (&hex)[32]) {
+    auto value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+    auto low_mask = _mm_set1_epi8(0x0f);
+    auto high = _mm_and_si128(_mm_srli_epi16(value, 4), low_mask);
+    auto low = _mm_and_si128(value, low_mask);
+    __m128i nibbles[2] = { _mm_unpacklo_epi8(high, low), _mm_unpackhi_epi8(high, low) };
+    for(int i = 0; i < 2; ++i) {
+        // '0' + n for digits, 'a' - 10 + n for letters
+        auto letter = _mm_cmpgt_epi8(nibbles[i], _mm_set1_epi8(9));
+        auto letter_offset = _mm_and_si128(letter, _mm_set1_epi8('a' - '0' - 10));
+        auto offset = _mm_add_epi8(_mm_set1_epi8('0'), letter_offset);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(hex + 16 * i),
+                         _mm_add_epi8(nibbles[i], offset));
+    }
+}
+#else
+void bytesToHex(const uint8_t (&bytes)[16], char (&hex)[32]) {
+    constexpr char digits[] = "0123456789abcdef";
+    for(int i = 0; i < 16; ++i) {
+        hex[2 * i] = digits[bytes[i] >> 4];
+        hex[2 * i + 1] = digits[bytes[i] & 0xf];
+    }
+}
+#endif
+
+} // namespace
+
+bool GuidText::decode(const char* text, Guid& out) {
+    uint8_t n[guid_length];
+    if(text[8] != '-' || text[13] != '-' || text[18] != '-' || text[23] != '-' ||
+       !toNibbles(text, n))
+        return false;
+
+    auto byte = [&n](size_t i) { return static_cast<uint8_t>(n[i] << 4 | n[i + 1]); };
+    out.Data1 = static_cast<uint32_t>(byte(0)) << 24 | byte(2) << 16 | byte(4) << 8 | byte(6);
+    out.Data2 = static_cast<uint16_t>(byte(9) << 8 | byte(11));
+    out.Data3 = static_cast<uint16_t>(byte(14) << 8 | byte(16));
+    out.Data4[0] = byte(19);
+    out.Data4[1] = byte(21);
+    for(size_t i = 0; i < 6; ++i)
+        out.Data4[2 + i] = byte(24 + 2 * i);
+    return true;
+}
+
+std::optional<Guid> GuidText::parse(std::string_view text) {
+    Guid parsed;
+    if(text.size() != guid_length || !decode(text.data(), parsed))
+        return std::nullopt;
+    return parsed;
+}
+
+size_t GuidText::parseMany(std::string_view packed, Guid* out) {
+    size_t count = packed.size() / guid_length;
+    for(size_t i = 0; i < count; ++i)
+        if(!decode(packed.data() + i * guid_length, out[i]))
+            return i;
+    return count;
+}
+
+char* GuidText::format(const Guid& id, char* out) {
+    uint8_t bytes[16];
+    char hex[32];
+    textOrderBytes(id, bytes);
+    bytesToHex(bytes, hex);
+
+    memcpy(out, hex, 8);
+    out[8] = '-';
+    memcpy(out + 9, hex + 8, 4);
+    out[13] = '-';
+    memcpy(out + 14, hex + 12, 4);
+    out[18] = '-';
+    memcpy(out + 19, hex + 16, 4);
+    out[23] = '-';
+    memcpy(out + 24, hex + 20, 12);
+    return out + guid_length;
+}
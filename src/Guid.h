@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+// 16-byte id with the memory layout of the Win32 GUID: a 32-bit and two 16-bit fields in native
+// byte order followed by 8 bytes. Ids the game passes in can be read as Guid directly, only the
+// game boundary needs the Win32 type.
+struct Guid {
+    uint32_t Data1;
+    uint16_t Data2;
+    uint16_t Data3;
+    uint8_t Data4[8];
+
+    bool operator==(const Guid&) const = default;
+};
+
+static_assert(sizeof(Guid) == 16);
+
+// Conversions between Guid and its 36 character text form xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx.
+// Decoding uses SSE2 where available and a scalar loop elsewhere, neither allocates.
+namespace GuidText {
+
+constexpr size_t length = 36;
+
+// text must point to length readable characters. Hex digits may be in either case, returns false
+// if any character besides the four dashes isn't one.
+bool decode(const char* text, Guid& out);
+
+std::optional<Guid> parse(std::string_view text);
+
+// Parses ids stored back to back in packed, length characters each. Returns the number of ids
+// written to out, parsing stops at the first invalid id.
+size_t parseMany(std::string_view packed, Guid* out);
+
+// Writes the lowercase text form to out (not null terminated) and returns the end of the written
+// range
+char* format(const Guid& id, char* out);
+
+} // namespace GuidText
@@ -0,0 +1,275 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <emmintrin.h>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "Hash.h"
+#include "RepositoryID.h"
+
+// Flat open addressing hash map keyed by 16-byte repository ids (Swiss table layout). Every
+// slot has a control byte that is either empty, deleted or the low 7 bits of the key's hash.
+// Lookups probe groups of 16 control bytes with one SSE2 compare and only touch the slots
+// whose control byte matches, each of which is checked with a single 128-bit compare.
+//
+// V must be default constructible. Pointers returned by find() and emplace() are invalidated
+// by any insertion that grows the table.
+template <typename V>
+class GuidMap {
+public:
+    GuidMap() = default;
+    explicit GuidMap(size_t expected_size) {
+        reserve(expected_size);
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    void clear() {
+        ctrl.clear();
+        slots.clear();
+        count = 0;
+        growth_left = 0;
+    }
+
+    // Sizes the table so that expected_size entries can be inserted without rehashing.
+    void reserve(size_t expected_size) {
+        size_t capacity = group_size;
+        while(capacity - capacity / 8 < expected_size)
+            capacity *= 2;
+        if(capacity > slots.size())
+            rehash(capacity);
+    }
+
+    V* find(const RepositoryID& key) {
+        auto pos = findPos(key);
+        return pos == npos ? nullptr : &slots[pos].value;
+    }
+
+    const V* find(const RepositoryID& key) const {
+        auto pos = findPos(key);
+        return pos == npos ? nullptr : &slots[pos].value;
+    }
+
+    bool contains(const RepositoryID& key) const {
+        return findPos(key) != npos;
+    }
+
+    // Inserts key if it isn't present yet. Returns the entry's value and whether it was inserted.
+    std::pair<V*, bool> emplace(const RepositoryID& key, V value = V()) {
+        auto h = hash(key);
+        auto pos = findPos(key, h);
+        if(pos != npos)
+            return { &slots[pos].value, false };
+
+        // Out of empty slots: grow, or only drop the tombstones if most of them are deleted
+        if(growth_left == 0) {
+            if(slots.empty())
+                rehash(group_size);
+            else
+                rehash(count * 2 < slots.size() - slots.size() / 8 ? slots.size()
+                                                                    : slots.size() * 2);
+        }
+
+        pos = findFree(h);
+        if(ctrl[pos] == ctrl_empty)
+            --growth_left;
+        ctrl[pos] = h2(h);
+        slots[pos].key = key;
+        slots[pos].value = std::move(value);
+        ++count;
+        return { &slots[pos].value, true };
+    }
+
+    V& operator[](const RepositoryID& key) {
+        return *emplace(key).first;
+    }
+
+    bool erase(const RepositoryID& key) {
+        auto pos = findPos(key);
+        if(pos == npos)
+            return false;
+
+        // A group without empty slots may be part of another key's probe sequence, so the
+        // slot has to stay occupied (deleted) to keep that sequence intact
+        auto group = pos & ~(group_size - 1);
+        if(matchEmpty(group)) {
+            ctrl[pos] = ctrl_empty;
+            ++growth_left;
+        } else {
+            ctrl[pos] = ctrl_deleted;
+        }
+        slots[pos].value = V();
+        --count;
+        return true;
+    }
+
+    // Calls fn(key, value) for every entry, in table order.
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for(size_t pos = 0; pos < slots.size(); ++pos)
+            if(isFull(ctrl[pos]))
+                fn(slots[pos].key, slots[pos].value);
+    }
+
+private:
+    static constexpr size_t group_size = 16;
+    static constexpr size_t npos = ~size_t(0);
+    static constexpr int8_t ctrl_empty = -128;
+    static constexpr int8_t ctrl_deleted = -2;
+
+    struct alignas(16) Slot {
+        RepositoryID key;
+        V value;
+    };
+
+    std::vector<int8_t> ctrl;
+    std::vector<Slot> slots;
+    size_t count = 0;
+    size_t growth_left = 0;
+
+    static bool isFull(int8_t c) {
+        return c >= 0;
+    }
+
+    static uint64_t hash(const RepositoryID& key) {
+        static_assert(sizeof(key.id) == 16);
+        uint64_t words[2];
+        memcpy(words, &key.id, sizeof(words));
+        return Hash::hash128(words[0], words[1]);
+    }
+
+    // Bits 0-6 go to the control byte, the rest selects the first group
+    static int8_t h2(uint64_t h) {
+        return static_cast<int8_t>(h & 0x7f);
+    }
+
+    size_t firstGroup(uint64_t h) const {
+        return static_cast<size_t>(h >> 7) * group_size & (slots.size() - 1);
+    }
+
+    static bool keyEquals(const RepositoryID& a, const RepositoryID& b) {
+        auto va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&a.id));
+        auto vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&b.id));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) == 0xffff;
+    }
+
+    __m128i loadGroup(size_t group) const {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(&ctrl[group]));
+    }
+
+    uint32_t match(size_t group, int8_t c) const {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(loadGroup(group), _mm_set1_epi8(c)));
+    }
+
+    uint32_t matchEmpty(size_t group) const {
+        return match(group, ctrl_empty);
+    }
+
+    // Empty and deleted both have the top bit set
+    uint32_t matchEmptyOrDeleted(size_t group) const {
+        return _mm_movemask_epi8(loadGroup(group));
+    }
+
+    size_t findPos(const RepositoryID& key) const {
+        return findPos(key, hash(key));
+    }
+
+    // Triangular probing over whole groups visits every group once for power of two sizes
+    size_t findPos(const RepositoryID& key, uint64_t h) const {
+        if(count == 0)
+            return npos;
+
+        auto group = firstGroup(h);
+        for(size_t step = group_size;; step += group_size) {
+            for(auto mask = match(group, h2(h)); mask != 0; mask &= mask - 1) {
+                auto pos = group + std::countr_zero(mask);
+                if(keyEquals(slots[pos].key, key))
+                    return pos;
+            }
+            if(matchEmpty(group))
+                return npos;
+            group = (group + step) & (slots.size() - 1);
+        }
+    }
+
+    size_t findFree(uint64_t h) const {
+        auto group = firstGroup(h);
+        for(size_t step = group_size;; step += group_size) {
+            if(auto mask = matchEmptyOrDeleted(group))
+                return group + std::countr_zero(mask);
+            group = (group + step) & (slots.size() - 1);
+        }
+    }
+
+    void rehash(size_t capacity) {
+        auto old_ctrl = std::move(ctrl);
+        auto old_slots = std::move(slots);
+
+        ctrl.assign(capacity, ctrl_empty);
+        slots.assign(capacity, Slot());
+        growth_left = capacity - capacity / 8;
+
+        for(size_t pos = 0; pos < old_slots.size(); ++pos) {
+            if(!isFull(old_ctrl[pos]))
+                continue;
+            auto h = hash(old_slots[pos].key);
+            auto free_pos = findFree(h);
+            ctrl[free_pos] = h2(h);
+            slots[free_pos] = std::move(old_slots[pos]);
+            --growth_left;
+        }
+    }
+};
+
+// Set of repository ids with the same layout.
+class GuidSet {
+public:
+    GuidSet() = default;
+    explicit GuidSet(size_t expected_size) : map(expected_size) {
+    }
+
+    size_t size() const {
+        return map.size();
+    }
+
+    bool empty() const {
+        return map.empty();
+    }
+
+    void clear() {
+        map.clear();
+    }
+
+    void reserve(size_t expected_size) {
+        map.reserve(expected_size);
+    }
+
+    // Returns true if key wasn't in the set before.
+    bool insert(const RepositoryID& key) {
+        return map.emplace(key).second;
+    }
+
+    bool contains(const RepositoryID& key) const {
+        return map.contains(key);
+    }
+
+    bool erase(const RepositoryID& key) {
+        return map.erase(key);
+    }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        map.forEach([&fn](const RepositoryID& key, const std::monostate&) { fn(key); });
+    }
+
+private:
+    GuidMap<std::monostate> map;
+};
@@ -0,0 +1,114 @@
+#include "GuidPerfectHash.h"
+#include "Hash.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+// Average number of keys per bucket, lower values build faster but need more seeds
+constexpr size_t keys_per_bucket = 4;
+constexpr uint32_t max_bucket_seed = 1 << 20;
+
+static void loadWords(const RepositoryID& key, uint64_t& lo, uint64_t& hi) {
+    static_assert(sizeof(key.id) == 16);
+    memcpy(&lo, &key.id, 8);
+    memcpy(&hi, reinterpret_cast<const char*>(&key.id) + 8, 8);
+}
+
+GuidPerfectHash::GuidPerfectHash(const std::vector<RepositoryID>& keys) {
+    // A failed build means a bucket found no collision free seed, retry with a new global seed
+    for(seed = 0; seed < 64; ++seed)
+        if(build(keys))
+            return;
+    throw std::runtime_error("GuidPerfectHash: failed to build perfect hash, duplicate keys?");
+}
+
+uint64_t GuidPerfectHash::hash(const RepositoryID& key) const {
+    uint64_t lo, hi;
+    loadWords(key, lo, hi);
+    return Hash::hash128(lo, hi, seed);
+}
+
+uint64_t GuidPerfectHash::fingerprint(const RepositoryID& key) const {
+    uint64_t lo, hi;
+    loadWords(key, lo, hi);
+    return Hash::mix64(hi ^ Hash::mix64(lo + 0x632be59bd9b4e019));
+}
+
+uint32_t GuidPerfectHash::bucket(uint64_t h) const {
+    return static_cast<uint32_t>((h >> 32) % bucket_seeds.size());
+}
+
+uint32_t GuidPerfectHash::slot(uint64_t h, uint32_t bucket_seed) const {
+    return static_cast<uint32_t>(Hash::mix64(h + bucket_seed * 0x9e3779b97f4a7c15) % slots.size());
+}
+
+bool GuidPerfectHash::build(const std::vector<RepositoryID>& keys) {
+    auto n = keys.size();
+    bucket_seeds.assign(std::max<size_t>(1, (n + keys_per_bucket - 1) / keys_per_bucket), 0);
+    slots.assign(n, Slot{ 0, 0 });
+    if(n == 0)
+        return true;
+
+    std::vector<std::vector<uint32_t>> buckets(bucket_seeds.size());
+    std::vector<uint64_t> hashes(n);
+    for(uint32_t i = 0; i < n; ++i) {
+        hashes[i] = hash(keys[i]);
+        buckets[bucket(hashes[i])].push_back(i);
+    }
+
+    // Place the largest buckets first while there are many free slots
+    std::vector<uint32_t> order(buckets.size());
+    for(uint32_t b = 0; b < order.size(); ++b)
+        order[b] = b;
+    std::sort(order.begin(), order.end(),
+              [&buckets](uint32_t a, uint32_t b) { return buckets[a].size() > buckets[b].size(); });
+
+    std::vector<bool> taken(n, false);
+    std::vector<uint32_t> bucket_slots;
+    for(const auto& b : order) {
+        const auto& members = buckets[b];
+        if(members.empty())
+            break;
+
+        bool placed = false;
+        for(uint32_t bucket_seed = 0; bucket_seed < max_bucket_seed && !placed; ++bucket_seed) {
+            bucket_slots.clear();
+            placed = true;
+            for(const auto& i : members) {
+                auto s = slot(hashes[i], bucket_seed);
+                if(taken[s] ||
+                   std::find(bucket_slots.begin(), bucket_slots.end(), s) != bucket_slots.end()) {
+                    placed = false;
+                    break;
+                }
+                bucket_slots.push_back(s);
+            }
+
+            if(placed) {
+                bucket_seeds[b] = bucket_seed;
+                for(size_t k = 0; k < members.size(); ++k) {
+                    taken[bucket_slots[k]] = true;
+                    slots[bucket_slots[k]] = Slot{ fingerprint(keys[members[k]]), members[k] };
+                }
+            }
+        }
+        if(!placed)
+            return false;
+    }
+    return true;
+}
+
+std::optional<uint32_t> GuidPerfectHash::find(const RepositoryID& key) const {
+    if(slots.empty())
+        return std::nullopt;
+
+    auto h = hash(key);
+    const auto& s = slots[slot(h, bucket_seeds[bucket(h)])];
+    if(s.fingerprint != fingerprint(key))
+        return std::nullopt;
+    return s.value;
+}
+
+size_t GuidPerfectHash::size() const {
+    return slots.size();
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "RepositoryID.h"
+
+// Minimal perfect hash over a fixed set of repository ids (hash and displace, CHD style).
+// A lookup reads one bucket seed and one slot; the slot's 64-bit fingerprint rejects ids that
+// aren't part of the set. Keys map to their index in the vector the table was built from.
+class GuidPerfectHash {
+public:
+    GuidPerfectHash() = default;
+    explicit GuidPerfectHash(const std::vector<RepositoryID>& keys);
+
+    std::optional<uint32_t> find(const RepositoryID& key) const;
+    size_t size() const;
+
+private:
+    struct Slot {
+        uint64_t fingerprint;
+        uint32_t value;
+    };
+
+    uint64_t seed = 0;
+    std::vector<uint32_t> bucket_seeds;
+    std::vector<Slot> slots;
+
+    bool build(const std::vector<RepositoryID>& keys);
+    uint64_t hash(const RepositoryID& key) const;
+    uint64_t fingerprint(const RepositoryID& key) const;
+    uint32_t bucket(uint64_t h) const;
+    uint32_t slot(uint64_t h, uint32_t bucket_seed) const;
+};
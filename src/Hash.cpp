@@ -2,4 +2,14 @@
 
 size_t Hash::hash_combine(const size_t h0, const size_t h1) {
 	return (h0 << 1) ^ h1;
-}
\ No newline at end of file
+}
+
+uint64_t Hash::bytes(const void* data, size_t size, uint64_t seed) {
+	uint64_t hash = 0xcbf29ce484222325 ^ (seed * 0x9e3779b97f4a7c15);
+	auto p = static_cast<const uint8_t*>(data);
+	for(size_t i = 0; i < size; ++i) {
+		hash ^= p[i];
+		hash *= 0x100000001b3;
+	}
+	return mix64(hash);
+}
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <type_traits>
 #include <string>
 
@@ -18,6 +19,29 @@ namespace Hash
 		return hash;
 	}
 
+	//Finalizer from splitmix64, every input bit affects every output bit
+	constexpr uint64_t mix64(uint64_t x) {
+		x ^= x >> 30;
+		x *= 0xbf58476d1ce4e5b9;
+		x ^= x >> 27;
+		x *= 0x94d049bb133111eb;
+		x ^= x >> 31;
+		return x;
+	}
+
+	//Order dependent combination of 64-bit hashes
+	constexpr uint64_t combine64(uint64_t h, uint64_t value) {
+		return mix64(h ^ (value + 0x9e3779b97f4a7c15 + (h << 6) + (h >> 2)));
+	}
+
+	//FNV-1a over a byte range, finalized with mix64. Stable across runs and builds.
+	uint64_t bytes(const void* data, size_t size, uint64_t seed = 0);
+
+	//Hash of a 128-bit key given as two words, used for GUID keyed tables
+	constexpr uint64_t hash128(uint64_t lo, uint64_t hi, uint64_t seed = 0) {
+		return mix64(lo ^ mix64(hi ^ (seed * 0x9e3779b97f4a7c15)));
+	}
+
 	constexpr size_t constexpr_hash(const std::string& s, size_t seed = 0x100000001b3) {
 		return constexpr_hash(s.c_str());
 	}
@@ -1,26 +1,27 @@
-#include <unordered_map>
 #include "Item.h"
-
-
-std::unordered_map<std::string, ICON> icon_map{
-	{"melee", ICON::MELEE},
-	{"key", ICON::KEY },
-	{"explosives", ICON::EXPLOSIVE },
-	{"questitem", ICON::QUESTITEM },
-	{"tool", ICON::TOOL },
-	{"sniperrifle", ICON::SNIPERRIFLE },
-	{"assaultrifle", ICON::ASSAULTRIFLE },
-	{"remote", ICON::REMOTE },
-	{"QuestItem", ICON::QUESTITEM },
-	{"shotgun", ICON::SHOTGUN },
-	{"suitcase", ICON::SUITCASE },
-	{"pistol", ICON::PISTOL },
-	{"INVALID_CATEGORY_ICON", ICON::INVALID_CATEGORY_ICON },
-	{"distraction", ICON::DISTRACTION },
-	{"poison", ICON::POISON },
-	{"Container", ICON::CONTAINER },
-	{"smg", ICON::SMG },
-};
+#include "Console.h"
+#include "EnumMap.h"
+
+
+constexpr auto icon_map = makeEnumMap<ICON>({
+	{ "melee", ICON::MELEE },
+	{ "key", ICON::KEY },
+	{ "explosives", ICON::EXPLOSIVE },
+	{ "questitem", ICON::QUESTITEM },
+	{ "tool", ICON::TOOL },
+	{ "sniperrifle", ICON::SNIPERRIFLE },
+	{ "assaultrifle", ICON::ASSAULTRIFLE },
+	{ "remote", ICON::REMOTE },
+	{ "QuestItem", ICON::QUESTITEM },
+	{ "shotgun", ICON::SHOTGUN },
+	{ "suitcase", ICON::SUITCASE },
+	{ "pistol", ICON::PISTOL },
+	{ "INVALID_CATEGORY_ICON", ICON::INVALID_CATEGORY_ICON },
+	{ "distraction", ICON::DISTRACTION },
+	{ "poison", ICON::POISON },
+	{ "Container", ICON::CONTAINER },
+	{ "smg", ICON::SMG },
+});
 
 inline ICON operator|(ICON i, ICON j) {
 	using T = std::underlying_type_t<ICON>;
@@ -32,52 +33,74 @@ inline ICON operator&(ICON i, ICON j) {
 	return static_cast<ICON>(static_cast<T>(i) & static_cast<T>(j));
 }
 
-std::unordered_map<std::string, CHEAT_GROUP> cheat_group_map{
-	{ "eCGNone", CHEAT_GROUP::NONE},
+constexpr auto cheat_group_map = makeEnumMap<CHEAT_GROUP>({
+	{ "eCGNone", CHEAT_GROUP::NONE },
 	{ "eCGDevices", CHEAT_GROUP::DEVICES },
 	{ "eCGSniper", CHEAT_GROUP::SNIPERS },
 	{ "eCGAssaultRifles", CHEAT_GROUP::ASSAULTRIFLES },
 	{ "eCGPistols", CHEAT_GROUP::PISTOLS },
 	{ "eCGShotguns", CHEAT_GROUP::SHOTGUNS },
 	{ "eCGExotics", CHEAT_GROUP::EXOTICS },
-	{ "eCGSMGs", CHEAT_GROUP::SMGS }
-};
-
-std::unordered_map<std::string, THROW_TYPE> throw_type_map{
-        { "THROW_NONE", THROW_TYPE::NONE},
-        { "THROW_PACIFY_LIGHT", THROW_TYPE::PACIFY_LIGHT},
-        { "THROW_PACIFY_HEAVY", THROW_TYPE::PACIFY_HEAVY},
-        { "THROW_DEADLY_LIGHT", THROW_TYPE::DEADLY_LIGHT},
-        { "THROW_DEADLY_HEAVY", THROW_TYPE::DEADLY_HEAVY},
-};
-
-std::unordered_map<std::string, SILENCE_RATING> SILENCE_RATING_map{
-        { "NONE", SILENCE_RATING::NONE},
-        { "eSR_NotSilenced", SILENCE_RATING::NOT_SILENCED},
-        { "eSR_Silenced", SILENCE_RATING::SILENCED},
-        { "eSR_SuperSilenced", SILENCE_RATING::SUPER_SILENCED},
-};
-
-Item::Item() {
-
-}
-
-Item::Item(const json& config) {
-	if (!config.is_object())
-		throw "Item repository corrupted";
-
-	try {
-		icon = icon_map[config["InventoryCategoryIcon"].get<std::string>()];
-		cheat_group = cheat_group_map[config["CheatGroup"].get<std::string>()];
-		common_name = config["CommonName"].get<std::string>();
-		throw_type = throw_type_map[config["ThrowType"].get<std::string>()];
-		silence_rating = SILENCE_RATING_map[config.value("SilenceRating", "NONE")];
-	}
-	catch (...) {
-		//There doesn't seem to be a convinient way to tell if a key exists in the json object.
-		//The repository builder should ensure that all keys are present!
-		throw "ItemConfig(const json& config): Some key is missing from constructor json";
+	{ "eCGSMGs", CHEAT_GROUP::SMGS },
+});
+
+constexpr auto throw_type_map = makeEnumMap<THROW_TYPE>({
+	{ "THROW_NONE", THROW_TYPE::NONE },
+	{ "THROW_PACIFY_LIGHT", THROW_TYPE::PACIFY_LIGHT },
+	{ "THROW_PACIFY_HEAVY", THROW_TYPE::PACIFY_HEAVY },
+	{ "THROW_DEADLY_LIGHT", THROW_TYPE::DEADLY_LIGHT },
+	{ "THROW_DEADLY_HEAVY", THROW_TYPE::DEADLY_HEAVY },
+});
+
+constexpr auto silence_rating_map = makeEnumMap<SILENCE_RATING>({
+	{ "NONE", SILENCE_RATING::NONE },
+	{ "eSR_NotSilenced", SILENCE_RATING::NOT_SILENCED },
+	{ "eSR_Silenced", SILENCE_RATING::SILENCED },
+	{ "eSR_SuperSilenced", SILENCE_RATING::SUPER_SILENCED },
+});
+
+std::optional<ICON> Item::parseIcon(std::string_view name) {
+	return icon_map.find(name);
+}
+
+std::optional<CHEAT_GROUP> Item::parseCheatGroup(std::string_view name) {
+	return cheat_group_map.find(name);
+}
+
+std::optional<THROW_TYPE> Item::parseThrowType(std::string_view name) {
+	return throw_type_map.find(name);
+}
+
+std::optional<SILENCE_RATING> Item::parseSilenceRating(std::string_view name) {
+	return silence_rating_map.find(name);
+}
+
+template<typename T>
+static T decodeField(std::optional<T> value,
+					 const char* field,
+					 const ItemDescriptor& desc,
+					 const std::string& raw) {
+	if(!value) {
+		LOG_ERROR("Item: unknown %s \"%s\" for %s\n", field, raw.c_str(), desc.common_name.c_str());
+		throw "Item: Unknown attribute value in repository entry";
 	}
+	return *value;
+}
+
+static_assert(sizeof(Item) == 8,
+	"Item is expected to pack into 4 attribute bytes plus a 4-byte name offset");
+
+Item::Item() : common_name(names().intern("")) {
+
+}
+
+Item::Item(const ItemDescriptor& desc) {
+	icon = decodeField(parseIcon(desc.icon), "InventoryCategoryIcon", desc, desc.icon);
+	cheat_group = decodeField(parseCheatGroup(desc.cheat_group), "CheatGroup", desc, desc.cheat_group);
+	common_name = names().intern(desc.common_name);
+	throw_type = decodeField(parseThrowType(desc.throw_type), "ThrowType", desc, desc.throw_type);
+	silence_rating =
+		decodeField(parseSilenceRating(desc.silence_rating), "SilenceRating", desc, desc.silence_rating);
 }
 
 bool Item::isEssential() const {
@@ -144,14 +167,49 @@ bool Item::isNotEssentialAndNotWeapon() const {
 	return !isEssential() && !isWeapon();
 }
 
-const std::string& Item::string() const {
-	return common_name;
+std::string_view Item::string() const {
+	return names().view(common_name);
+}
+
+const char* Item::c_str() const {
+	return names().c_str(common_name);
+}
+
+StringArena& Item::names() {
+	static StringArena arena;
+	return arena;
 }
 
 const ICON& Item::getType() const {
 	return icon;
 }
 
+//Category name as used by InventoryCategoryIcon in Repository.json
+const char* Item::getTypeName() const {
+	switch (icon) {
+	case ICON::MELEE: return "melee";
+	case ICON::KEY: return "key";
+	case ICON::EXPLOSIVE: return "explosives";
+	case ICON::QUESTITEM: return "questitem";
+	case ICON::TOOL: return "tool";
+	case ICON::SNIPERRIFLE: return "sniperrifle";
+	case ICON::ASSAULTRIFLE: return "assaultrifle";
+	case ICON::REMOTE: return "remote";
+	case ICON::SHOTGUN: return "shotgun";
+	case ICON::SUITCASE: return "suitcase";
+	case ICON::PISTOL: return "pistol";
+	case ICON::DISTRACTION: return "distraction";
+	case ICON::POISON: return "poison";
+	case ICON::CONTAINER: return "Container";
+	case ICON::SMG: return "smg";
+	default: return "INVALID_CATEGORY_ICON";
+	}
+}
+
+const CHEAT_GROUP& Item::getCheatGroup() const {
+	return cheat_group;
+}
+
 const THROW_TYPE& Item::getThrowType() const {
     return throw_type;
 }
@@ -161,12 +219,5 @@ const SILENCE_RATING& Item::getSilenceRating() const {
 }
 
 void Item::print() const {
-	//inefficient but it's only for debug printing so shouldn't matter
-	std::string icon_name;
-	for(const auto& i : icon_map)
-		if (i.second == getType()) {
-			icon_name = i.first;
-			break;
-		}
-	printf("%s : %s : isEssential = %d\n", string().c_str(), icon_name.c_str(), isEssential());
+	LOG_INFO("%s : %s : isEssential = %d\n", string(), getTypeName(), isEssential());
 }
\ No newline at end of file
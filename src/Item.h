@@ -1,11 +1,12 @@
 #pragma once
 
+#include <cstdint>
+#include <optional>
 #include <string>
-#include "..\thirdparty\json.hpp"
+#include <string_view>
+#include "StringArena.h"
 
-using json = nlohmann::json;
-
-enum class ICON {
+enum class ICON : uint8_t {
 	MELEE,
 	KEY,
 	EXPLOSIVE,
@@ -24,7 +25,7 @@ enum class ICON {
 	SMG,
 };
 
-enum class CHEAT_GROUP {
+enum class CHEAT_GROUP : uint8_t {
 	NONE,
 	DEVICES,
 	SNIPERS,
@@ -35,7 +36,7 @@ enum class CHEAT_GROUP {
 	SMGS,
 };
 
-enum class THROW_TYPE {
+enum class THROW_TYPE : uint8_t {
     NONE,
     PACIFY_LIGHT,
     PACIFY_HEAVY,
@@ -43,24 +44,43 @@ enum class THROW_TYPE {
     DEADLY_HEAVY,
 };
 
-enum class SILENCE_RATING {
+enum class SILENCE_RATING : uint8_t {
     NONE,
     NOT_SILENCED,
     SILENCED,
     SUPER_SILENCED,
 };
 
+//Raw attributes of a repository entry as they appear in Repository.json
+struct ItemDescriptor {
+	std::string icon;
+	std::string cheat_group;
+	std::string common_name;
+	std::string throw_type;
+	std::string silence_rating = "NONE";
+	double weight = 1.0; //optional, relative draw weight for weighted randomisation
+};
+
+//Attributes take one byte each, the common name is an offset into the shared name arena
+//since it is only read for logging and name filters
 class Item {
 	ICON icon;
 	CHEAT_GROUP cheat_group;
 	THROW_TYPE throw_type;
 	SILENCE_RATING silence_rating;
 
-	std::string common_name;
+	uint32_t common_name;
 
 public:
 	Item();
-	Item(const json& config);
+	//Throws if an attribute has a value that isn't known
+	Item(const ItemDescriptor& desc);
+
+	//Attribute values as they appear in Repository.json, unknown values give std::nullopt
+	static std::optional<ICON> parseIcon(std::string_view name);
+	static std::optional<CHEAT_GROUP> parseCheatGroup(std::string_view name);
+	static std::optional<THROW_TYPE> parseThrowType(std::string_view name);
+	static std::optional<SILENCE_RATING> parseSilenceRating(std::string_view name);
 
 	bool isEssential() const;
 	bool isNotEssential() const; 
@@ -79,11 +99,19 @@ public:
 	bool isDistraction() const;
 	bool isNotEssentialAndNotWeapon()const;
 
-	const std::string& string() const;
+	std::string_view string() const;
+	const char* c_str() const;
 	const ICON& getType() const;
+	const char* getTypeName() const;
+	const CHEAT_GROUP& getCheatGroup() const;
 	const THROW_TYPE& getThrowType() const;
 	const SILENCE_RATING& getSilenceRating() const;
 
 	void print() const;
+
+	bool operator==(const Item&) const = default;
+
+	//Arena holding the common names of all items ever loaded
+	static StringArena& names();
 };
 
@@ -0,0 +1,111 @@
+#include "ItemBitset.h"
+#include <algorithm>
+
+ItemBitset::ItemBitset(size_t size) : bits(size), words((size + 63) / 64, 0) {
+}
+
+size_t ItemBitset::size() const {
+    return bits;
+}
+
+void ItemBitset::resize(size_t size) {
+    bits = size;
+    words.resize((size + 63) / 64, 0);
+    clearPadding();
+}
+
+size_t ItemBitset::count() const {
+    size_t cnt = 0;
+    for(const auto& word : words)
+        cnt += std::popcount(word);
+    return cnt;
+}
+
+size_t ItemBitset::countAnd(const ItemBitset& other) const {
+    size_t cnt = 0;
+    auto shared = std::min(words.size(), other.words.size());
+    for(size_t w = 0; w < shared; ++w)
+        cnt += std::popcount(words[w] & other.words[w]);
+    return cnt;
+}
+
+bool ItemBitset::test(uint32_t pos) const {
+    return (words[pos / 64] >> (pos % 64)) & 1;
+}
+
+void ItemBitset::set(uint32_t pos) {
+    words[pos / 64] |= uint64_t(1) << (pos % 64);
+}
+
+void ItemBitset::reset(uint32_t pos) {
+    words[pos / 64] &= ~(uint64_t(1) << (pos % 64));
+}
+
+uint64_t ItemBitset::hash() const {
+    uint64_t hash = 0xcbf29ce484222325 ^ bits;
+    for(const auto& word : words) {
+        hash ^= word;
+        hash *= 0x100000001b3;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+bool ItemBitset::operator==(const ItemBitset& other) const {
+    return bits == other.bits && words == other.words;
+}
+
+uint32_t ItemBitset::select(size_t rank) const {
+    for(size_t w = 0; w < words.size(); ++w) {
+        size_t cnt = std::popcount(words[w]);
+        if(rank < cnt) {
+            uint64_t word = words[w];
+            for(size_t i = 0; i < rank; ++i)
+                word &= word - 1;
+            return static_cast<uint32_t>(w * 64 + std::countr_zero(word));
+        }
+        rank -= cnt;
+    }
+    return static_cast<uint32_t>(bits);
+}
+
+ItemBitset& ItemBitset::operator&=(const ItemBitset& other) {
+    auto shared = std::min(words.size(), other.words.size());
+    for(size_t w = 0; w < shared; ++w)
+        words[w] &= other.words[w];
+    std::fill(words.begin() + shared, words.end(), 0);
+    return *this;
+}
+
+ItemBitset& ItemBitset::operator|=(const ItemBitset& other) {
+    auto shared = std::min(words.size(), other.words.size());
+    for(size_t w = 0; w < shared; ++w)
+        words[w] |= other.words[w];
+    clearPadding();
+    return *this;
+}
+
+ItemBitset ItemBitset::operator&(const ItemBitset& other) const {
+    ItemBitset res(*this);
+    res &= other;
+    return res;
+}
+
+ItemBitset ItemBitset::operator|(const ItemBitset& other) const {
+    ItemBitset res(*this);
+    res |= other;
+    return res;
+}
+
+ItemBitset ItemBitset::operator~() const {
+    ItemBitset res(*this);
+    for(auto& word : res.words)
+        word = ~word;
+    res.clearPadding();
+    return res;
+}
+
+void ItemBitset::clearPadding() {
+    if(bits % 64)
+        words.back() &= (uint64_t(1) << (bits % 64)) - 1;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Fixed-size set of item handles, one bit per repository entry. Used to combine candidate
+// sets without rescanning the repository.
+class ItemBitset {
+public:
+    ItemBitset() = default;
+    explicit ItemBitset(size_t size);
+
+    size_t size() const;
+    // Grows or shrinks the set, added positions are cleared.
+    void resize(size_t size);
+    size_t count() const;
+    // Size of the intersection with other without building it. Sets of different sizes are
+    // compared as if the smaller one was padded with cleared bits.
+    size_t countAnd(const ItemBitset& other) const;
+    bool test(uint32_t pos) const;
+    void set(uint32_t pos);
+    void reset(uint32_t pos);
+
+    // Content hash, equal sets hash equally.
+    uint64_t hash() const;
+    bool operator==(const ItemBitset& other) const;
+
+    // Returns the position of the rank-th set bit (0 based). rank must be smaller than count().
+    uint32_t select(size_t rank) const;
+
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for(size_t w = 0; w < words.size(); ++w) {
+            uint64_t word = words[w];
+            while(word) {
+                fn(static_cast<uint32_t>(w * 64 + std::countr_zero(word)));
+                word &= word - 1;
+            }
+        }
+    }
+
+    // Sets of different sizes are combined like countAnd() compares them, the result keeps the
+    // size of the left operand.
+    ItemBitset& operator&=(const ItemBitset& other);
+    ItemBitset& operator|=(const ItemBitset& other);
+    ItemBitset operator&(const ItemBitset& other) const;
+    ItemBitset operator|(const ItemBitset& other) const;
+    ItemBitset operator~() const;
+
+private:
+    size_t bits = 0;
+    std::vector<uint64_t> words;
+
+    void clearPadding();
+};
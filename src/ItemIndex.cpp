@@ -0,0 +1,156 @@
+#include "ItemIndex.h"
+#include "Console.h"
+#include <algorithm>
+#include <iterator>
+
+CandidateSet::CandidateSet(size_t repository_size) : bits(repository_size) {
+}
+
+void CandidateSet::add(ItemHandle handle) {
+    handles.push_back(handle);
+    bits.set(handle);
+}
+
+void CandidateSet::remove(ItemHandle handle) {
+    handles.erase(std::find(handles.begin(), handles.end(), handle));
+    bits.reset(handle);
+}
+
+bool CandidateSet::empty() const {
+    return handles.empty();
+}
+
+size_t CandidateSet::size() const {
+    return handles.size();
+}
+
+// Predicates used by the randomisation strategies, indexed up front.
+static const ItemIndex::Predicate default_predicates[] = {
+    &Item::isEssential,   &Item::isNotEssential, &Item::isKey,    &Item::isQuestItem,
+    &Item::isWeapon,      &Item::isPistol,       &Item::isSmg,    &Item::isAssaultRifle,
+    &Item::isShotgun,     &Item::isSniper,       &Item::isMelee,  &Item::isExplosive,
+    &Item::isTool,        &Item::isSuitcase,     &Item::isDistraction,
+    &Item::isNotEssentialAndNotWeapon,
+};
+
+ItemIndex::ItemIndex(const std::vector<Item>& items_,
+                     const ItemBitset& live_,
+                     const ItemIndex* previous,
+                     const std::vector<ItemHandle>& changed)
+: items(items_), live(live_), all_items(0) {
+    if(previous) {
+        all_items = previous->all_items;
+        icons = previous->icons;
+        cheat_groups = previous->cheat_groups;
+        throw_types = previous->throw_types;
+        groups = previous->groups;
+        for(const auto& predicate : previous->predicates) {
+            predicates.emplace_back(predicate.first,
+                                    std::make_unique<CandidateSet>(*predicate.second));
+        }
+    } else {
+        icons.assign(static_cast<size_t>(ICON::SMG) + 1, CandidateSet(0));
+        cheat_groups.assign(static_cast<size_t>(CHEAT_GROUP::SMGS) + 1, CandidateSet(0));
+        throw_types.assign(static_cast<size_t>(THROW_TYPE::DEADLY_HEAVY) + 1, CandidateSet(0));
+        groups.assign(std::size(WellKnownItems::groups), CandidateSet(0));
+        for(const auto& fn : default_predicates)
+            predicates.emplace_back(fn, std::make_unique<CandidateSet>(0));
+    }
+
+    update(changed);
+
+    for(const auto& entry : WellKnownItems::groups) {
+        if(byGroup(entry.group).empty())
+            LOG_ERROR("ItemIndex: no item named %s in the repository\n", entry.common_names[0]);
+    }
+}
+
+template <typename Fn>
+void ItemIndex::updateSet(CandidateSet& set, Fn&& member, const std::vector<ItemHandle>& rows) {
+    set.bits.resize(items.size());
+    for(const auto& handle : rows) {
+        bool wanted = live.test(handle) && member(items[handle]);
+        if(wanted && !set.bits.test(handle))
+            set.add(handle);
+        else if(!wanted && set.bits.test(handle))
+            set.remove(handle);
+    }
+}
+
+void ItemIndex::update(const std::vector<ItemHandle>& rows) {
+    updateSet(all_items, [](const Item&) { return true; }, rows);
+    for(size_t i = 0; i < icons.size(); ++i) {
+        updateSet(icons[i], [i](const Item& it) { return static_cast<size_t>(it.getType()) == i; },
+                  rows);
+    }
+    for(size_t i = 0; i < cheat_groups.size(); ++i) {
+        updateSet(cheat_groups[i], [i](const Item& it) {
+            return static_cast<size_t>(it.getCheatGroup()) == i;
+        }, rows);
+    }
+    for(size_t i = 0; i < throw_types.size(); ++i) {
+        updateSet(throw_types[i], [i](const Item& it) {
+            return static_cast<size_t>(it.getThrowType()) == i;
+        }, rows);
+    }
+    for(size_t i = 0; i < groups.size(); ++i) {
+        updateSet(groups[i], [i](const Item& it) {
+            const auto& names = WellKnownItems::groups[i].common_names;
+            return std::find(names.begin(), names.end(), it.string()) != names.end();
+        }, rows);
+    }
+    for(auto& predicate : predicates) {
+        auto fn = predicate.first;
+        updateSet(*predicate.second, [fn](const Item& it) { return (it.*fn)(); }, rows);
+    }
+}
+
+const CandidateSet& ItemIndex::all() const {
+    return all_items;
+}
+
+const CandidateSet& ItemIndex::byIcon(ICON icon) const {
+    return icons[static_cast<size_t>(icon)];
+}
+
+const CandidateSet& ItemIndex::byCheatGroup(CHEAT_GROUP cheat_group) const {
+    return cheat_groups[static_cast<size_t>(cheat_group)];
+}
+
+const CandidateSet& ItemIndex::byThrowType(THROW_TYPE throw_type) const {
+    return throw_types[static_cast<size_t>(throw_type)];
+}
+
+const CandidateSet& ItemIndex::byGroup(WellKnownGroup group) const {
+    return groups[static_cast<size_t>(group)];
+}
+
+const CandidateSet& ItemIndex::byPredicate(Predicate fn) {
+    for(const auto& predicate : predicates)
+        if(predicate.first == fn)
+            return *predicate.second;
+    return addPredicate(fn);
+}
+
+CandidateSet ItemIndex::fromBits(const ItemBitset& bits) const {
+    CandidateSet set(items.size());
+    bits.forEach([&set](uint32_t handle) { set.add(handle); });
+    return set;
+}
+
+CandidateSet ItemIndex::fromPredicate(const std::function<bool(const Item&)>& fn) const {
+    CandidateSet set(items.size());
+    for(const auto& handle : all_items.handles)
+        if(fn(items[handle]))
+            set.add(handle);
+    return set;
+}
+
+const CandidateSet& ItemIndex::addPredicate(Predicate fn) {
+    auto set = std::make_unique<CandidateSet>(items.size());
+    for(const auto& handle : all_items.handles)
+        if((items[handle].*fn)())
+            set->add(handle);
+    predicates.emplace_back(fn, std::move(set));
+    return *predicates.back().second;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "Item.h"
+#include "ItemBitset.h"
+#include "WellKnownItems.h"
+
+// Dense index of an item in the repository. Handles are assigned in load order and stay
+// valid for the lifetime of the repository.
+using ItemHandle = uint32_t;
+
+// All items satisfying some criterion, both as a dense array for O(1) random draws and as a
+// bitset for combining criteria.
+struct CandidateSet {
+    std::vector<ItemHandle> handles;
+    ItemBitset bits;
+
+    explicit CandidateSet(size_t repository_size);
+
+    void add(ItemHandle handle);
+    void remove(ItemHandle handle);
+    bool empty() const;
+    size_t size() const;
+};
+
+// Precomputed candidate sets over the live rows of the repository for every ICON, CHEAT_GROUP,
+// THROW_TYPE, WellKnownGroup and Item::is* predicate.
+class ItemIndex {
+public:
+    using Predicate = bool (Item::*)() const;
+
+    // Starts from a copy of previous (or from empty sets) and re-evaluates the changed rows only,
+    // so a reload that touches a few items doesn't rebuild every set.
+    ItemIndex(const std::vector<Item>& items,
+              const ItemBitset& live,
+              const ItemIndex* previous,
+              const std::vector<ItemHandle>& changed);
+
+    const CandidateSet& all() const;
+    const CandidateSet& byIcon(ICON icon) const;
+    const CandidateSet& byCheatGroup(CHEAT_GROUP cheat_group) const;
+    const CandidateSet& byThrowType(THROW_TYPE throw_type) const;
+    // Items belonging to a well-known group, empty if all of them are missing or ignored.
+    const CandidateSet& byGroup(WellKnownGroup group) const;
+
+    // Candidate set of a member predicate. Predicates that aren't part of the prebuilt table are
+    // indexed on first use and kept for subsequent calls.
+    const CandidateSet& byPredicate(Predicate fn);
+
+    // Converts a combination of candidate bitsets back into a drawable candidate set.
+    CandidateSet fromBits(const ItemBitset& bits) const;
+    // Builds a candidate set for an ad hoc predicate, this scans the whole repository.
+    CandidateSet fromPredicate(const std::function<bool(const Item&)>& fn) const;
+
+private:
+    const std::vector<Item>& items;
+    const ItemBitset& live;
+
+    CandidateSet all_items;
+    std::vector<CandidateSet> icons;
+    std::vector<CandidateSet> cheat_groups;
+    std::vector<CandidateSet> throw_types;
+    std::vector<CandidateSet> groups;
+    std::vector<std::pair<Predicate, std::unique_ptr<CandidateSet>>> predicates;
+
+    const CandidateSet& addPredicate(Predicate fn);
+    void update(const std::vector<ItemHandle>& rows);
+    template <typename Fn>
+    void updateSet(CandidateSet& set, Fn&& member, const std::vector<ItemHandle>& rows);
+};
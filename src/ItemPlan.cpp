@@ -0,0 +1,119 @@
+#include "ItemPlan.h"
+#include <bit>
+#include "Hash.h"
+
+static constexpr ItemHandle empty_entry = ~ItemHandle(0);
+
+ItemPlan::ItemPlan(std::pmr::memory_resource* memory) : memory(memory) {
+}
+
+ItemPlan::~ItemPlan() {
+    releaseIndex();
+    if(plan)
+        memory->deallocate(plan, capacity * sizeof(*plan), alignof(const RepositoryID*));
+}
+
+void ItemPlan::reset(size_t new_capacity) {
+    if(new_capacity > capacity) {
+        if(plan)
+            memory->deallocate(plan, capacity * sizeof(*plan), alignof(const RepositoryID*));
+        plan = static_cast<const RepositoryID**>(
+        memory->allocate(new_capacity * sizeof(*plan), alignof(const RepositoryID*)));
+        capacity = new_capacity;
+    }
+    releaseIndex();
+    plan_size = 0;
+    cursor = 0;
+}
+
+std::span<const RepositoryID*> ItemPlan::appendFree(size_t count) {
+    if(plan_size + count > capacity)
+        throw "ItemPlan: Plan exceeds its capacity";
+    auto slots = std::span(plan + plan_size, count);
+    plan_size += count;
+    return slots;
+}
+
+void ItemPlan::truncate(size_t size) {
+    plan_size = std::min(plan_size, size);
+}
+
+size_t ItemPlan::size() const {
+    return plan_size;
+}
+
+const RepositoryID* ItemPlan::next() {
+    if(cursor == plan_size)
+        return nullptr;
+    return plan[cursor++];
+}
+
+size_t ItemPlan::remaining() const {
+    return plan_size - cursor;
+}
+
+std::span<const RepositoryID* const> ItemPlan::slots() const {
+    return std::span(plan, plan_size);
+}
+
+void ItemPlan::releaseIndex() {
+    if(table)
+        memory->deallocate(table, table_size * sizeof(*table), alignof(OriginalEntry));
+    if(occurrences)
+        memory->deallocate(occurrences, occurrences_size * sizeof(*occurrences), alignof(uint32_t));
+    table = nullptr;
+    table_size = 0;
+    occurrences = nullptr;
+    occurrences_size = 0;
+}
+
+ItemPlan::OriginalEntry& ItemPlan::findEntry(ItemHandle original) {
+    auto mask = table_size - 1;
+    for(auto i = Hash::mix64(original) & mask;; i = (i + 1) & mask) {
+        if(table[i].original == original || table[i].original == empty_entry)
+            return table[i];
+    }
+}
+
+void ItemPlan::indexByOriginal(std::span<const ItemHandle> originals) {
+    if(originals.size() != plan_size)
+        throw "ItemPlan: Keyed plans need one slot per position";
+
+    releaseIndex();
+    table_size = std::bit_ceil(std::max<size_t>(2 * plan_size, 16));
+    table = static_cast<OriginalEntry*>(
+    memory->allocate(table_size * sizeof(*table), alignof(OriginalEntry)));
+    std::fill(table, table + table_size, OriginalEntry{ empty_entry, 0, 0, 0 });
+    occurrences_size = plan_size;
+    occurrences = static_cast<uint32_t*>(
+    memory->allocate(occurrences_size * sizeof(*occurrences), alignof(uint32_t)));
+
+    // Counting sort of the positions by original item, taken serves as the fill cursor
+    for(auto original : originals) {
+        auto& entry = findEntry(original);
+        entry.original = original;
+        ++entry.count;
+    }
+    uint32_t begin = 0;
+    for(size_t i = 0; i < table_size; ++i) {
+        table[i].begin = begin;
+        begin += table[i].count;
+    }
+    for(uint32_t pos = 0; pos < originals.size(); ++pos) {
+        auto& entry = findEntry(originals[pos]);
+        occurrences[entry.begin + entry.taken++] = pos;
+    }
+    for(size_t i = 0; i < table_size; ++i)
+        table[i].taken = 0;
+}
+
+bool ItemPlan::take(ItemHandle original, const RepositoryID*& slot) {
+    if(!table)
+        return false;
+    auto& entry = findEntry(original);
+    if(entry.taken == entry.count)
+        return false;
+    slot = plan[occurrences[entry.begin + entry.taken++]];
+    ++cursor;
+    return true;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <random>
+#include <span>
+#include "ItemIndex.h"
+#include "RepositoryID.h"
+
+// Slot by slot replacement plan of a world item pool, consumed front to back as the game
+// spawns items. Layout is linear in the number of slots and reuses the storage of the previous
+// plan, so a plan costs at most one allocation from its memory resource.
+class ItemPlan {
+public:
+    explicit ItemPlan(std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+    ItemPlan(const ItemPlan&) = delete;
+    ItemPlan& operator=(const ItemPlan&) = delete;
+    ~ItemPlan();
+
+    // Starts an empty plan with room for capacity slots.
+    void reset(size_t capacity);
+
+    // Appends count free slots for the caller to fill before layout(). Throws if the plan would
+    // grow beyond the capacity given to reset().
+    std::span<const RepositoryID*> appendFree(size_t count);
+    // Drops free slots past size, for slots the caller couldn't fill.
+    void truncate(size_t size);
+    size_t size() const;
+
+    // Shuffles the free items and interleaves them with count fixed slots filled by draw(). The
+    // i-th fixed slot lands at positions[i] (ascending), or at the end of the plan if there are
+    // too few free items in front of it.
+    template <typename Draw>
+    void layout(std::span<const int> positions, size_t count, std::mt19937& rng, Draw&& draw);
+
+    // Returns the next slot and advances the cursor, nullptr once the plan is exhausted.
+    const RepositoryID* next();
+
+    // Order independent alternative to next() for plans with one slot per pool position: slot i
+    // replaces the item at position i. Builds a flat table from each original item to its
+    // positions, so take() finds the slot of the n-th occurrence of an item in O(1).
+    void indexByOriginal(std::span<const ItemHandle> originals);
+    // Looks up the slot of the next unused occurrence of original and advances the cursor.
+    // Returns false if original has no position left.
+    bool take(ItemHandle original, const RepositoryID*& slot);
+
+    size_t remaining() const;
+    std::span<const RepositoryID* const> slots() const;
+
+private:
+    // Positions of one original item: occurrences[begin, begin + count), the first taken are used
+    struct OriginalEntry {
+        ItemHandle original;
+        uint32_t begin;
+        uint32_t count;
+        uint32_t taken;
+    };
+
+    std::pmr::memory_resource* memory;
+    const RepositoryID** plan = nullptr;
+    size_t plan_size = 0;
+    size_t capacity = 0;
+    size_t cursor = 0;
+
+    // Open addressing, power of two size and at most half full
+    OriginalEntry* table = nullptr;
+    size_t table_size = 0;
+    uint32_t* occurrences = nullptr;
+    size_t occurrences_size = 0;
+
+    OriginalEntry& findEntry(ItemHandle original);
+    void releaseIndex();
+};
+
+template <typename Draw>
+void ItemPlan::layout(std::span<const int> positions,
+                      size_t count,
+                      std::mt19937& rng,
+                      Draw&& draw) {
+    auto free_count = plan_size;
+    std::shuffle(plan, plan + free_count, rng);
+
+    count = std::min(count, positions.size());
+    auto target = [&](size_t i) { return std::min<size_t>(positions[i], free_count + i); };
+    appendFree(count);
+
+    // Back to front: free items only move towards the end, so none is overwritten before it has
+    // been moved. Once all fixed slots are passed the remaining free items are in place.
+    auto next_free = free_count;
+    for(auto fixed = count, pos = plan_size; fixed > 0;) {
+        --pos;
+        if(pos == target(fixed - 1))
+            --fixed;
+        else
+            plan[pos] = plan[--next_free];
+    }
+
+    for(size_t i = 0; i < count; ++i)
+        plan[target(i)] = draw();
+}
@@ -0,0 +1,80 @@
+#include "MappedFile.h"
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& path)
+: file(INVALID_HANDLE_VALUE), mapping(nullptr), base(nullptr), length(0) {
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                       FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+        return;
+
+    LARGE_INTEGER file_size;
+    if(!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+        return;
+
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(mapping == nullptr)
+        return;
+
+    base = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if(base != nullptr)
+        length = static_cast<size_t>(file_size.QuadPart);
+}
+
+MappedFile::~MappedFile() {
+    if(base != nullptr)
+        UnmapViewOfFile(base);
+    if(mapping != nullptr)
+        CloseHandle(mapping);
+    if(file != INVALID_HANDLE_VALUE)
+        CloseHandle(file);
+}
+#else
+// The descriptor is closed right away, the mapping stays valid without it
+MappedFile::MappedFile(const std::string& path)
+: file(nullptr), mapping(nullptr), base(nullptr), length(0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        return;
+
+    struct stat info;
+    if(fstat(fd, &info) == 0 && info.st_size > 0) {
+        auto view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if(view != MAP_FAILED) {
+            mapping = view;
+            base = static_cast<const char*>(view);
+            length = static_cast<size_t>(info.st_size);
+        }
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if(mapping != nullptr)
+        munmap(mapping, length);
+}
+#endif
+
+bool MappedFile::isOpen() const {
+    return base != nullptr;
+}
+
+const char* MappedFile::data() const {
+    return base;
+}
+
+size_t MappedFile::size() const {
+    return length;
+}
+
+std::string_view MappedFile::view() const {
+    return std::string_view(base, length);
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Read-only view of a file mapped into memory. The mapping lives as long as the object.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    bool isOpen() const;
+    const char* data() const;
+    size_t size() const;
+    std::string_view view() const;
+
+private:
+    void* file;
+    void* mapping;
+    const char* base;
+    size_t length;
+};
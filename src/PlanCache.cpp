@@ -0,0 +1,178 @@
+#include "PlanCache.h"
+#include "Config.h"
+#include "Console.h"
+#include "DefaultItemPool.h"
+#include "Hash.h"
+#include "MappedFile.h"
+#include "Repository.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Bump when plan generation changes, so that entries written by older builds are ignored
+constexpr uint32_t format_version = 2;
+constexpr uint32_t magic = 0x4e4c505a; // "ZPLN"
+// Oldest entries are removed beyond this, an entry is a few KiB
+constexpr size_t max_entries = 64;
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t slot_count;
+    uint32_t rng_state_size;
+};
+
+std::filesystem::path directory() {
+    return std::filesystem::path(Config::retailPath("PlanCache"));
+}
+
+std::filesystem::path entryPath(uint64_t key) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llX.plan", static_cast<unsigned long long>(key));
+    return directory() / name;
+}
+
+uint64_t hashString(std::string_view text) {
+    return Hash::bytes(text.data(), text.size());
+}
+
+uint64_t hashWords(uint64_t h, const std::vector<std::string>& words) {
+    h = Hash::combine64(h, words.size());
+    for(const auto& word : words)
+        h = Hash::combine64(h, hashString(word));
+    return h;
+}
+
+// Order independent, the maps are unordered
+uint64_t hashWeights(const std::unordered_map<std::string, double>& weights) {
+    uint64_t sum = 0;
+    for(const auto& [name, weight] : weights)
+        sum += Hash::combine64(hashString(name), Hash::bytes(&weight, sizeof(weight)));
+    return Hash::combine64(weights.size(), sum);
+}
+
+void evictOldEntries() {
+    std::error_code ec;
+    std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> entries;
+    for(const auto& entry : std::filesystem::directory_iterator(directory(), ec))
+        if(entry.path().extension() == ".plan")
+            entries.emplace_back(entry.last_write_time(ec), entry.path());
+    if(entries.size() <= max_entries)
+        return;
+
+    std::sort(entries.begin(), entries.end());
+    for(size_t i = 0; i < entries.size() - max_entries; ++i)
+        std::filesystem::remove(entries[i].second, ec);
+}
+
+} // namespace
+
+std::optional<uint64_t> PlanCache::key(Scenario scen,
+                                       const ItemRepository& repo,
+                                       const DefaultItemPool& pool,
+                                       bool keyed) {
+    const auto& config = Config::current();
+    if(config.RNGSeed == 0)
+        return std::nullopt;
+
+    uint64_t h = Hash::combine64(format_version, static_cast<uint32_t>(config.RNGSeed));
+    h = Hash::combine64(h, scen);
+    h = Hash::combine64(h, hashString(config.worldInventoryRandomizer));
+    h = hashWords(h, config.customWorldAllowedWords);
+    h = hashWords(h, config.customWorldIgnoredWords);
+    h = Hash::combine64(h, static_cast<uint32_t>(config.worldItemMaxRepeats));
+    h = Hash::combine64(h, keyed);
+    h = Hash::combine64(h, hashWeights(config.categoryWeights));
+    h = Hash::combine64(h, hashWeights(config.itemWeights));
+    h = Hash::combine64(h, repo.getContentHash());
+    return Hash::combine64(h, pool.contentHash());
+}
+
+bool PlanCache::load(uint64_t key, const ItemRepository& repo, ItemPlan& plan, std::mt19937& rng) {
+    MappedFile file(entryPath(key).string());
+    if(!file.isOpen() || file.size() < sizeof(Header))
+        return false;
+
+    Header header;
+    memcpy(&header, file.data(), sizeof(header));
+    auto slots_size = size_t(header.slot_count) * sizeof(RepositoryID);
+    auto expected_size = sizeof(Header) + slots_size + header.rng_state_size;
+    if(header.magic != magic || header.version != format_version || header.key != key ||
+       file.size() != expected_size)
+        return false;
+
+    std::istringstream rng_state(
+    std::string(file.data() + sizeof(Header) + slots_size, header.rng_state_size));
+    std::mt19937 restored_rng;
+    rng_state >> restored_rng;
+    if(rng_state.fail())
+        return false;
+
+    plan.reset(header.slot_count);
+    auto slots = plan.appendFree(header.slot_count);
+    auto ids = file.data() + sizeof(Header);
+    for(size_t i = 0; i < slots.size(); ++i) {
+        RepositoryID id;
+        memcpy(&id, ids + i * sizeof(RepositoryID), sizeof(RepositoryID));
+        // The nil id marks a slot that keeps its original item
+        if(id == RepositoryID()) {
+            slots[i] = nullptr;
+            continue;
+        }
+        slots[i] = repo.getStablePointer(id);
+        if(slots[i] == nullptr) {
+            plan.reset(0);
+            return false;
+        }
+    }
+
+    rng = restored_rng;
+    return true;
+}
+
+void PlanCache::store(uint64_t key, const ItemPlan& plan, const std::mt19937& rng) {
+    std::ostringstream rng_state;
+    rng_state << rng;
+    auto rng_text = rng_state.str();
+
+    auto slots = plan.slots();
+    Header header{ magic, format_version, key, static_cast<uint32_t>(slots.size()),
+                   static_cast<uint32_t>(rng_text.size()) };
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory(), ec);
+    auto path = entryPath(key);
+    auto temp_path = path;
+    temp_path += ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        const RepositoryID keep_original;
+        for(const auto* id : slots) {
+            const auto* written = id ? id : &keep_original;
+            out.write(reinterpret_cast<const char*>(written), sizeof(RepositoryID));
+        }
+        out.write(rng_text.data(), rng_text.size());
+        if(!out) {
+            LOG_ERROR("PlanCache: could not write %s\n", temp_path.string().c_str());
+            return;
+        }
+    }
+
+    // Readers never see a partially written entry
+    std::filesystem::rename(temp_path, path, ec);
+    if(ec) {
+        LOG_ERROR("PlanCache: could not write %s: %s\n", path.string().c_str(),
+                  ec.message().c_str());
+        std::filesystem::remove(temp_path, ec);
+        return;
+    }
+    evictOldEntries();
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <random>
+#include "ItemPlan.h"
+#include "Scenario.h"
+
+class DefaultItemPool;
+class ItemRepository;
+
+// On-disk cache of world item plans. With a fixed RNG seed the plan of a scenario only depends
+// on the seed, the world strategy and its configuration, and the contents of the repository and
+// the default pool. Plans are stored under a hash of all of these together with the RNG state
+// after the plan was built, so restoring both leaves the randomizer in the same state as
+// building the plan would. Any change to the inputs changes the key, stale entries are simply
+// never read again and eventually evicted.
+namespace PlanCache {
+
+// Key of the plan for scen, or nothing if plans aren't reproducible because the seed is random.
+// keyed is true for plans indexed by original item (see ItemPlan::indexByOriginal).
+std::optional<uint64_t>
+key(Scenario scen, const ItemRepository& repo, const DefaultItemPool& pool, bool keyed);
+
+// Fills plan and restores rng if a plan is cached under key. The entry is read through a file
+// mapping.
+bool load(uint64_t key, const ItemRepository& repo, ItemPlan& plan, std::mt19937& rng);
+
+// Writes the plan and the current rng state under key. Failures are logged and otherwise ignored,
+// the cache only saves time.
+void store(uint64_t key, const ItemPlan& plan, const std::mt19937& rng);
+
+} // namespace PlanCache
@@ -0,0 +1,220 @@
+#include "PushTrace.h"
+#include "Config.h"
+#include "MappedFile.h"
+#include <cstring>
+
+namespace {
+
+constexpr uint64_t timestamp_mask = (uint64_t(1) << 48) - 1;
+
+PushTrace::RecordHeader makeHeader(PushTrace::EventType type, uint8_t slot, uint64_t timestamp_ns) {
+    return { static_cast<uint64_t>(type) | uint64_t(slot) << 8 |
+             (timestamp_ns & timestamp_mask) << 16 };
+}
+
+PushTrace::EventType typeOf(PushTrace::RecordHeader header) {
+    return static_cast<PushTrace::EventType>(header.bits & 0xff);
+}
+
+size_t recordSize(PushTrace::EventType type) {
+    switch(type) {
+    case PushTrace::EventType::SceneLoad:
+        return sizeof(PushTrace::SceneLoadRecord);
+    case PushTrace::EventType::Seed:
+        return sizeof(PushTrace::SeedRecord);
+    case PushTrace::EventType::Push:
+        return sizeof(PushTrace::PushRecord);
+    case PushTrace::EventType::Thread:
+        return sizeof(PushTrace::ThreadRecord);
+    }
+    return 0;
+}
+
+} // namespace
+
+#ifdef PUSHTRACE
+#include <Windows.h>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include "Console.h"
+
+namespace {
+
+constexpr size_t buffer_bytes = 4096 * sizeof(PushTrace::PushRecord);
+
+class TraceWriter {
+public:
+    TraceWriter() : start(std::chrono::steady_clock::now()) {
+        buffer.reserve(buffer_bytes + sizeof(PushTrace::ThreadRecord) +
+                       sizeof(PushTrace::PushRecord));
+    }
+
+    // Sets the header of record and appends it, preceded by a Thread record if the calling thread
+    // isn't the one that recorded last
+    template <typename Record>
+    void record(PushTrace::EventType type, uint8_t slot, Record record, bool flush_now) {
+        std::lock_guard lock(mutex);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        auto timestamp_ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        auto thread_id = static_cast<uint32_t>(GetCurrentThreadId());
+        if(thread_id != last_thread_id) {
+            PushTrace::ThreadRecord thread{};
+            thread.header = makeHeader(PushTrace::EventType::Thread, 0, timestamp_ns);
+            thread.thread_id = thread_id;
+            append(thread);
+            last_thread_id = thread_id;
+        }
+        record.header = makeHeader(type, slot, timestamp_ns);
+        append(record);
+        if(flush_now || buffer.size() >= buffer_bytes)
+            flushLocked();
+    }
+
+    void flush() {
+        std::lock_guard lock(mutex);
+        flushLocked();
+    }
+
+private:
+    std::mutex mutex;
+    std::chrono::steady_clock::time_point start;
+    std::vector<char> buffer;
+    std::ofstream out;
+    uint32_t last_thread_id = 0;
+
+    template <typename Record>
+    void append(const Record& record) {
+        auto bytes = reinterpret_cast<const char*>(&record);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(record));
+    }
+
+    void open() {
+        auto directory = std::filesystem::path(Config::retailPath("PushTraces"));
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+
+        char name[32];
+        auto now = std::time(nullptr);
+        tm local;
+        localtime_s(&local, &now);
+        strftime(name, sizeof(name), "%Y%m%d-%H%M%S.trace", &local);
+        auto path = directory / name;
+
+        out.open(path, std::ios::binary | std::ios::trunc);
+        PushTrace::Header header{ PushTrace::magic, PushTrace::format_version,
+                                  sizeof(PushTrace::PushRecord), 0 };
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if(out)
+            LOG_INFO("PushTrace: writing %s\n", path.string());
+        else
+            LOG_ERROR("PushTrace: could not write %s\n", path.string());
+    }
+
+    void flushLocked() {
+        if(buffer.empty())
+            return;
+        if(!out.is_open())
+            open();
+        out.write(buffer.data(), buffer.size());
+        out.flush();
+        buffer.clear();
+    }
+};
+
+TraceWriter& writer() {
+    static TraceWriter instance;
+    return instance;
+}
+
+} // namespace
+
+void PushTrace::sceneLoad(const ScenarioKeys& keys) {
+    SceneLoadRecord record{};
+    record.scenario = keys.stable;
+    record.legacy_scenario = keys.legacy;
+    writer().record(EventType::SceneLoad, 0, record, true);
+}
+
+void PushTrace::seed(uint32_t seed) {
+    SeedRecord record{};
+    record.seed = seed;
+    writer().record(EventType::Seed, 0, record, false);
+}
+
+void PushTrace::push(RandomizerSlot slot, const RepositoryID* in, const RepositoryID* out) {
+    PushRecord record{};
+    record.in = *in;
+    record.out = *out;
+    writer().record(EventType::Push, static_cast<uint8_t>(slot), record, false);
+}
+
+void PushTrace::flush() {
+    writer().flush();
+}
+#endif
+
+std::vector<PushTrace::Event> PushTrace::read(const std::string& path) {
+    MappedFile file(path);
+    Header header;
+    if(!file.isOpen() || file.size() < sizeof(header))
+        throw "PushTrace: Trace could not be read";
+    memcpy(&header, file.data(), sizeof(header));
+    if(header.magic != magic || header.version != format_version ||
+       header.push_record_size != sizeof(PushRecord))
+        throw "PushTrace: File is not a push trace of this version";
+
+    std::vector<Event> events;
+    uint32_t thread_id = 0;
+    auto data = file.data();
+    size_t pos = sizeof(header);
+    // A trace of a session that ended mid write is truncated to its last complete record
+    while(file.size() - pos >= sizeof(RecordHeader)) {
+        RecordHeader record_header;
+        memcpy(&record_header, data + pos, sizeof(record_header));
+        auto type = typeOf(record_header);
+        auto size = recordSize(type);
+        if(!size)
+            throw "PushTrace: Trace contains a record of unknown type";
+        if(file.size() - pos < size)
+            break;
+
+        Event event{};
+        event.type = type;
+        event.slot = static_cast<uint8_t>(record_header.bits >> 8);
+        event.timestamp_ns = record_header.bits >> 16;
+        switch(type) {
+        case EventType::SceneLoad: {
+            SceneLoadRecord record;
+            memcpy(&record, data + pos, sizeof(record));
+            event.scenario = record.scenario;
+            event.legacy_scenario = record.legacy_scenario;
+        } break;
+        case EventType::Seed: {
+            SeedRecord record;
+            memcpy(&record, data + pos, sizeof(record));
+            event.seed = record.seed;
+        } break;
+        case EventType::Push: {
+            PushRecord record;
+            memcpy(&record, data + pos, sizeof(record));
+            event.in = record.in;
+            event.out = record.out;
+        } break;
+        case EventType::Thread: {
+            ThreadRecord record;
+            memcpy(&record, data + pos, sizeof(record));
+            thread_id = record.thread_id;
+        } break;
+        }
+        pos += size;
+        if(type == EventType::Thread)
+            continue;
+        event.thread_id = thread_id;
+        events.push_back(event);
+    }
+    return events;
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "RepositoryID.h"
+#include "Scenario.h"
+
+enum class RandomizerSlot;
+
+// Binary trace of the item pushes of a play session, for replaying real push streams through
+// strategies outside of a game session with the replay tool (tools/Replay.cpp). Capturing is
+// only compiled into builds that define PUSHTRACE, each run writes one file to
+// Retail\PushTraces. A trace is a Header followed by records in the order they were recorded,
+// written through a buffer that is flushed when it is full, on scene loads and on process detach.
+// Every record starts with a RecordHeader, the payload depends on the type: pushes, by far the
+// most frequent records, take 40 bytes.
+namespace PushTrace {
+
+constexpr uint32_t magic = 0x4352545a; // "ZTRC"
+constexpr uint32_t format_version = 2;
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t push_record_size;
+    uint32_t reserved;
+};
+
+enum class EventType : uint8_t {
+    SceneLoad, // scenario and legacy_scenario are set
+    Seed,      // seed is the RNG seed of the scene that was loaded last
+    Push,      // slot, in and out are set
+    Thread,    // thread_id of the following records, only recorded when it changes
+};
+
+// Type in the low 8 bits, slot in the next 8 and the timestamp in ns since the trace was started
+// in the upper 48
+struct RecordHeader {
+    uint64_t bits;
+};
+
+struct SceneLoadRecord {
+    RecordHeader header;
+    uint64_t scenario;
+    uint64_t legacy_scenario;
+};
+
+struct SeedRecord {
+    RecordHeader header;
+    uint32_t seed;
+    uint32_t reserved;
+};
+
+struct PushRecord {
+    RecordHeader header;
+    RepositoryID in;
+    RepositoryID out;
+};
+
+struct ThreadRecord {
+    RecordHeader header;
+    uint32_t thread_id;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(SceneLoadRecord) == 24);
+static_assert(sizeof(SeedRecord) == 16);
+static_assert(sizeof(PushRecord) == 40);
+static_assert(sizeof(ThreadRecord) == 16);
+
+// A record expanded for replay. Only the fields of its type are set, besides the timestamp and
+// the thread_id, which is taken from the last Thread record. Thread records aren't returned.
+struct Event {
+    uint64_t timestamp_ns; // since the trace was started
+    uint64_t scenario;
+    uint64_t legacy_scenario;
+    RepositoryID in;
+    RepositoryID out;
+    uint32_t thread_id;
+    uint32_t seed;
+    EventType type;
+    uint8_t slot; // RandomizerSlot
+};
+
+#ifdef PUSHTRACE
+void sceneLoad(const ScenarioKeys& keys);
+void seed(uint32_t seed);
+void push(RandomizerSlot slot, const RepositoryID* in, const RepositoryID* out);
+// Writes the buffered records, called on process detach
+void flush();
+#endif
+
+// Reads all records of a trace into events, throws if the file isn't a trace of this version
+std::vector<Event> read(const std::string& path);
+
+} // namespace PushTrace
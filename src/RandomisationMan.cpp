@@ -5,64 +5,89 @@
 #include "Offsets.h"
 #include "RNG.h"
 #include "SSceneInitParameters.h"
+#include <guiddef.h>
+#include <algorithm>
 #include <filesystem>
 
 #ifdef DEFAULTPOOLEXPORT
 #include "DefaultPoolExport.h"
 #endif
 
-std::unique_ptr<Randomizer> RandomisationMan::world_inventory_randomizer = nullptr;
-std::unique_ptr<Randomizer> RandomisationMan::npc_item_randomizer = nullptr;
-std::unique_ptr<Randomizer> RandomisationMan::hero_inventory_randomizer = nullptr;
-std::unique_ptr<Randomizer> RandomisationMan::stash_item_randomizer = nullptr;
+// The push detours hand the game's GUIDs to the randomizers as RepositoryIDs and back
+static_assert(sizeof(RepositoryID) == sizeof(GUID) && alignof(RepositoryID) == alignof(GUID));
+
+// Defined before the randomizers so that they are destroyed after them
+SceneArena RandomisationMan::scene_arenas[2];
+size_t RandomisationMan::scene_arena_index = 0;
+StrategyCache RandomisationMan::strategy_cache;
+
+// Jaccard similarity of the brick sets below which the pool of another scenario isn't used
+constexpr double min_borrowed_pool_similarity = 0.5;
+
+SceneArena::Ptr<Randomizer> RandomisationMan::world_inventory_randomizer = nullptr;
+SceneArena::Ptr<Randomizer> RandomisationMan::npc_item_randomizer = nullptr;
+SceneArena::Ptr<Randomizer> RandomisationMan::hero_inventory_randomizer = nullptr;
+SceneArena::Ptr<Randomizer> RandomisationMan::stash_item_randomizer = nullptr;
+
+RandomizerSlot RandomisationMan::slotOf(const SceneArena::Ptr<Randomizer>* rnd) {
+    if(rnd == &world_inventory_randomizer)
+        return RandomizerSlot::WorldInventory;
+    if(rnd == &npc_item_randomizer)
+        return RandomizerSlot::NPCInventory;
+    if(rnd == &hero_inventory_randomizer)
+        return RandomizerSlot::HeroInventory;
+    return RandomizerSlot::StashInventory;
+}
 
-template <typename T>
-RandomisationStrategy* createInstance() {
-    return new T;
+// Reuses the strategy of the slot if one was created for the current config before
+SceneArena::Ptr<Randomizer> RandomisationMan::createRandomizer(SceneArena& arena,
+                                                               RandomizerSlot slot,
+                                                               const std::string& name) {
+    const auto& factories = strategyFactories(slot);
+    auto factory = factories.find(name);
+    if(factory == factories.end()) {
+        LOG_ERROR("Unknown randomizer %s, using DEFAULT\n", name);
+        factory = factories.find("DEFAULT");
+    }
+    auto* strategy = &strategy_cache.get(slot, factory->first, factory->second);
+    if(!strategy->hasRequiredItems()) {
+        LOG_ERROR("Randomizer %s needs items that are missing from the repository, using NONE\n",
+                  factory->first);
+        factory = factories.find("NONE");
+        strategy = &strategy_cache.get(slot, factory->first, factory->second);
+    }
+    return arena.create<Randomizer>(strategy, &arena);
 }
 
-std::unordered_map<std::string, RandomisationStrategy* (*)()> worldRandomizers{
-    { "NONE", &createInstance<IdentityRandomisation> },
-    { "DEFAULT", &createInstance<WorldInventoryRandomisation> },
-    { "OOPS_ALL_EXPLOSIVES", &createInstance<OopsAllExplosivesWorldInventoryRandomization> },
-};
-
-std::unordered_map<std::string, RandomisationStrategy* (*)()> npcRandomizers{
-    { "NONE", &createInstance<IdentityRandomisation> },
-    { "DEFAULT", &createInstance<NPCItemRandomisation> },
-    { "HARD", &createInstance<UnrestrictedNPCRandomization> },
-    { "SLEEPY", &createInstance<SleepyNPCRandomization> },
-};
-
-std::unordered_map<std::string, RandomisationStrategy* (*)()> heroRandomizers{
-    { "NONE", &createInstance<IdentityRandomisation> },
-    { "DEFAULT", &createInstance<HeroInventoryRandomisation> },
-};
-
-std::unordered_map<std::string, RandomisationStrategy* (*)()> stashRandomizers{
-    { "NONE", &createInstance<IdentityRandomisation> },
-    { "DEFAULT", &createInstance<StashInventoryRandomisation> },
-};
-
-void RandomisationMan::configureRandomizerCollection() {
+void RandomisationMan::configureRandomizerCollection(SceneArena& arena) {
+    const auto& config = Config::current();
+    strategy_cache.beginScene();
     registerRandomizer(RandomizerSlot::WorldInventory,
-                       std::make_unique<Randomizer>(worldRandomizers[Config::worldInventoryRandomizer]()));
+                       createRandomizer(arena, RandomizerSlot::WorldInventory,
+                                        config.worldInventoryRandomizer));
     registerRandomizer(RandomizerSlot::NPCInventory,
-                       std::make_unique<Randomizer>(npcRandomizers[Config::npcInventoryRandomizer]()));
+                       createRandomizer(arena, RandomizerSlot::NPCInventory,
+                                        config.npcInventoryRandomizer));
     registerRandomizer(RandomizerSlot::HeroInventory,
-                       std::make_unique<Randomizer>(heroRandomizers[Config::heroInventoryRandomizer]()));
+                       createRandomizer(arena, RandomizerSlot::HeroInventory,
+                                        config.heroInventoryRandomizer));
     registerRandomizer(RandomizerSlot::StashInventory,
-                       std::make_unique<Randomizer>(stashRandomizers[Config::stashInventoryRandomizer]()));
+                       createRandomizer(arena, RandomizerSlot::StashInventory,
+                                        config.stashInventoryRandomizer));
 }
 
 RandomisationMan::RandomisationMan() {
     default_item_pool_repo = std::make_unique<DefaultItemPoolRepository>(
-    Config::base_directory + "\\Retail\\DefaultItemPools.json");
+    Config::retailPath("DefaultItemPools.json"),
+    Config::retailPath("ScenarioKeyMigrations.json"));
+    scenario_index =
+    std::make_unique<ScenarioIndex>(Config::retailPath("Scenarios.json"));
 
-    world_inventory_randomizer = std::make_unique<Randomizer>(new IdentityRandomisation);
-    npc_item_randomizer = std::make_unique<Randomizer>(new IdentityRandomisation);
-    hero_inventory_randomizer = std::make_unique<Randomizer>(new IdentityRandomisation);
-    stash_item_randomizer = std::make_unique<Randomizer>(new IdentityRandomisation);
+    auto& arena = scene_arenas[scene_arena_index];
+    world_inventory_randomizer = createRandomizer(arena, RandomizerSlot::WorldInventory, "NONE");
+    npc_item_randomizer = createRandomizer(arena, RandomizerSlot::NPCInventory, "NONE");
+    hero_inventory_randomizer = createRandomizer(arena, RandomizerSlot::HeroInventory, "NONE");
+    stash_item_randomizer = createRandomizer(arena, RandomizerSlot::StashInventory, "NONE");
 
     MemoryUtils::DetourCall(GameOffsets::instance()->getPushWorldInventoryDetour(),
                             reinterpret_cast<const void*>(&pushItem1Detour<&world_inventory_randomizer>));
@@ -74,7 +99,7 @@ RandomisationMan::RandomisationMan() {
                             reinterpret_cast<const void*>(&pushItem0Detour<&stash_item_randomizer>));
 }
 
-void RandomisationMan::registerRandomizer(RandomizerSlot slot, std::unique_ptr<Randomizer> rng) {
+void RandomisationMan::registerRandomizer(RandomizerSlot slot, SceneArena::Ptr<Randomizer> rng) {
     switch(slot) {
     case RandomizerSlot::WorldInventory:
         world_inventory_randomizer = std::move(rng);
@@ -94,31 +119,69 @@ void RandomisationMan::registerRandomizer(RandomizerSlot slot, std::unique_ptr<R
 void RandomisationMan::initializeRandomizers(const SSceneInitParameters* sip) {
     sip->print();
 
-    configureRandomizerCollection();
-
-    auto seed = Config::RNGSeed;
+    // Strategies bind to the current repository snapshot, reload before creating them
+    if(RandomDrawRepository::reloadIfChanged())
+        LOG_INFO("Reloaded item repository\n");
+    // The other arena holds the randomizers of the previous scene, which are still in use until
+    // they are replaced. This one only holds randomizers that were replaced a scene ago.
+    scene_arena_index ^= 1;
+    auto& arena = scene_arenas[scene_arena_index];
+    arena.release();
+    configureRandomizerCollection(arena);
+    RandomDrawRepository::inst().updateWeights();
+
+    auto seed = Config::current().RNGSeed;
     if(seed == 0)
         seed = std::random_device{}();
     RNG::inst().seed(seed);
+#ifdef PUSHTRACE
+    PushTrace::seed(seed);
+#endif
 
-    // auto scenario = Scenario::from_SceneInitParams(*sip);
-    auto scenario = std::hash<SSceneInitParameters>()(*sip);
+    auto composition = SceneComposition::from(*sip);
+    auto keys = ScenarioKeys::from(composition);
+    auto scenario = keys.stable;
 #ifdef DEFAULTPOOLEXPORT
     DefaultPoolExport::loadScenario(scenario);
 #endif
-    Console::log("Loading Scenario: %I64X\n", scenario);
-
-    auto default_pool = default_item_pool_repo->getDefaultPool(scenario);
+    LOG_INFO("Loading Scenario: %I64X (legacy %I64X)\n", scenario, keys.legacy);
+
+    auto default_pool = default_item_pool_repo->getDefaultPool(keys);
+    // A borrowed pool only approximates the items of the scene. The world randomizer then uses a
+    // keyed plan: an item is only replaced if the borrowed pool has a position for it, which holds
+    // an item of the same kind, and keys and quest items keep their own positions.
+    bool borrowed_pool = false;
+    if(default_pool) {
+        scenario_index->add(keys, composition);
+    } else if(auto match = scenario_index->nearest(composition)) {
+        if(match->similarity >= min_borrowed_pool_similarity)
+            default_pool = default_item_pool_repo->getDefaultPool(match->keys);
+
+        if(match->similarity < min_borrowed_pool_similarity) {
+            LOG_INFO("No default pool for this scenario, the most similar is %I64X (similarity "
+                     "%.2f)\n",
+                     match->keys.stable, match->similarity);
+        } else if(!default_pool) {
+            LOG_ERROR("No default pool for this scenario, the pool of the most similar %I64X "
+                      "(legacy %I64X) could not be loaded\n",
+                      match->keys.stable, match->keys.legacy);
+        } else {
+            borrowed_pool = true;
+            LOG_INFO("No default pool for this scenario, using the pool of %I64X (similarity "
+                     "%.2f)\n",
+                     match->keys.stable, match->similarity);
+        }
+    }
 
 #ifdef DEFAULTPOOLEXPORT
-    world_inventory_randomizer = std::make_unique<Randomizer>(new IdentityRandomisation);
+    world_inventory_randomizer = createRandomizer(arena, RandomizerSlot::WorldInventory, "NONE");
     world_inventory_randomizer->initialize(scenario, default_pool);
     npc_item_randomizer->disable();
     hero_inventory_randomizer->disable();
     stash_item_randomizer->disable();
 #else
     if(default_pool != nullptr) {
-        world_inventory_randomizer->initialize(scenario, default_pool);
+        world_inventory_randomizer->initialize(scenario, default_pool, borrowed_pool);
         npc_item_randomizer->initialize(scenario, default_pool);
         hero_inventory_randomizer->initialize(scenario, default_pool);
         stash_item_randomizer->initialize(scenario, default_pool);
@@ -129,4 +192,9 @@ void RandomisationMan::initializeRandomizers(const SSceneInitParameters* sip) {
         stash_item_randomizer->disable();
     }
 #endif
+
+    LOG_INFO("Scene arena: %zu bytes used, peak %zu bytes, %zu bytes reserved, %zu cached "
+             "strategies\n",
+             arena.usedBytes(), std::max(scene_arenas[0].peakBytes(), scene_arenas[1].peakBytes()),
+             arena.reservedBytes(), strategy_cache.size());
 }
\ No newline at end of file
@@ -1,27 +1,40 @@
 #pragma once
+#include <string>
+#include <unordered_map>
 #include "DefaultItemPoolRepository.h"
 #include "Offsets.h"
+#include "PushTrace.h"
 #include "Randomizer.h"
+#include "SceneArena.h"
 #include "Scenario.h"
+#include "ScenarioIndex.h"
+#include "StrategyCache.h"
 
 using pushItem0_t = __int64(
 __fastcall*)(__int64*, const RepositoryID*, __int64, void*, __int64, __int64, __int64*, void*, char*, char);
 using pushItem1_t = __int64(__fastcall*)(signed __int64*, const RepositoryID*, void*, __int64, __int64, __int64*, __int64*);
 
-enum class RandomizerSlot { WorldInventory, NPCInventory, HeroInventory, StashInventory };
-
 class RandomisationMan {
 private:
     std::unique_ptr<DefaultItemPoolRepository> default_item_pool_repo;
+    // Scenarios without a default pool fall back to the pool of the most similar known scenario
+    std::unique_ptr<ScenarioIndex> scenario_index;
+
+    // Randomizers live in the arena of the scene they were created for. Scenes alternate between
+    // two arenas, so the randomizers being replaced on a scene load are never in memory that is
+    // being reused for their successors. Their strategies are shared across scenes.
+    static SceneArena scene_arenas[2];
+    static size_t scene_arena_index;
+    static StrategyCache strategy_cache;
 
-    static std::unique_ptr<Randomizer> world_inventory_randomizer;
-    static std::unique_ptr<Randomizer> npc_item_randomizer;
-    static std::unique_ptr<Randomizer> hero_inventory_randomizer;
-    static std::unique_ptr<Randomizer> stash_item_randomizer;
+    static SceneArena::Ptr<Randomizer> world_inventory_randomizer;
+    static SceneArena::Ptr<Randomizer> npc_item_randomizer;
+    static SceneArena::Ptr<Randomizer> hero_inventory_randomizer;
+    static SceneArena::Ptr<Randomizer> stash_item_randomizer;
 
     // This function template is called by external game code
     // Don't touch the signature of this function.
-    template <std::unique_ptr<Randomizer>* rnd>
+    template <SceneArena::Ptr<Randomizer>* rnd>
     static __int64 __fastcall pushItem0Detour(__int64* worldInventory,
                                               const RepositoryID* repoId,
                                               __int64 a3,
@@ -33,13 +46,16 @@ private:
                                               char* a9,
                                               char a10) {
         const RepositoryID* id = (*rnd)->randomize(repoId);
+#ifdef PUSHTRACE
+        PushTrace::push(slotOf(rnd), repoId, id);
+#endif
         const auto push = reinterpret_cast<pushItem0_t>(GameOffsets::instance()->getPushItem0());
         return push(worldInventory, id, a3, a4, a5, a6, a7, a8, a9, a10);
     };
 
     // This function template is called by external game code
     // Don't touch the signature of this function.
-    template <std::unique_ptr<Randomizer>* rnd>
+    template <SceneArena::Ptr<Randomizer>* rnd>
     static __int64 __fastcall pushItem1Detour(signed __int64* a1,
                                               const RepositoryID* repoId,
                                               void* a3,
@@ -48,15 +64,21 @@ private:
                                               __int64* a6,
                                               __int64* a7) {
         const RepositoryID* id = (*rnd)->randomize(repoId);
+#ifdef PUSHTRACE
+        PushTrace::push(slotOf(rnd), repoId, id);
+#endif
         const auto push = reinterpret_cast<pushItem1_t>(GameOffsets::instance()->getPushItem1());
         return push(a1, id, a3, a4, a5, a6, a7);
     }
 
-    void configureRandomizerCollection();
+    void configureRandomizerCollection(SceneArena& arena);
+    static SceneArena::Ptr<Randomizer>
+    createRandomizer(SceneArena& arena, RandomizerSlot slot, const std::string& name);
+    static RandomizerSlot slotOf(const SceneArena::Ptr<Randomizer>* rnd);
 
 public:
     RandomisationMan();
 
-    void registerRandomizer(RandomizerSlot slot, std::unique_ptr<Randomizer> rng);
+    void registerRandomizer(RandomizerSlot slot, SceneArena::Ptr<Randomizer> rng);
     void initializeRandomizers(const SSceneInitParameters* scen);
 };
@@ -1,289 +1,438 @@
-# i n c l u d e   " R a n d o m i z e r . h "  
- # i n c l u d e   " C o n f i g . h "  
- # i n c l u d e   " C o n s o l e . h "  
- # i n c l u d e   " D e f a u l t I t e m P o o l . h "  
- # i n c l u d e   " I t e m . h "  
- # i n c l u d e   " O f f s e t s . h "  
- # i n c l u d e   " R N G . h "  
- # i n c l u d e   " R e p o s i t o r y . h "  
- # i n c l u d e   < a l g o r i t h m >  
- # i n c l u d e   < r a n d o m >  
- # i f d e f   D E F A U L T P O O L E X P O R T  
- # i n c l u d e   " D e f a u l t P o o l E x p o r t . h "  
- # e n d i f  
-  
- R a n d o m i s a t i o n S t r a t e g y : : R a n d o m i s a t i o n S t r a t e g y ( )   :   r e p o ( R a n d o m D r a w R e p o s i t o r y : : i n s t ( ) )   {  
- }  
-  
- v o i d   R a n d o m i s a t i o n S t r a t e g y : : i n i t i a l i z e ( S c e n a r i o ,   c o n s t   D e f a u l t I t e m P o o l *   c o n s t )   {  
- }  
-  
- c o n s t   R e p o s i t o r y I D *   W o r l d I n v e n t o r y R a n d o m i s a t i o n : : r a n d o m i z e ( c o n s t   R e p o s i t o r y I D *   i n _ o u t _ I D )   {  
-         i f ( r e p o . c o n t a i n s ( * i n _ o u t _ I D )   & &   i t e m _ q u e u e . s i z e ( ) )   {  
-                 c o n s t   R e p o s i t o r y I D *   i d   =   i t e m _ q u e u e . f r o n t ( ) ;  
-                 i t e m _ q u e u e . p o p ( ) ;  
-                 C o n s o l e : : l o g ( " W o r l d I n v e n t o r y R a n d o m i s a t i o n : : r a n d o m i z e :   % d :   % s   - >   % s \ n " ,  
-                                           s t a t i c _ c a s t < i n t > ( i t e m _ q u e u e . s i z e ( ) ) ,   r e p o . g e t I t e m ( * i n _ o u t _ I D ) - > s t r i n g ( ) . c _ s t r ( ) ,  
-                                           r e p o . g e t I t e m ( * i d ) - > s t r i n g ( ) . c _ s t r ( ) ) ;  
-                 r e t u r n   i d ;  
-         }   e l s e   {  
-                 i f ( ! i t e m _ q u e u e . s i z e ( ) )  
-                         C o n s o l e : : l o g ( " W o r l d I n v e n t o r y R a n d o m i s a t i o n : : r a n d o m i z e :   s k i p p e d   ( q u e u e   e x h a u s t e d )   [ % s ] \ n " ,  
-                                                   i n _ o u t _ I D - > t o S t r i n g ( ) . c _ s t r ( ) ) ;  
-                 e l s e  
-                         C o n s o l e : : l o g ( " W o r l d I n v e n t o r y R a n d o m i s a t i o n : : r a n d o m i z e :   s k i p p e d   ( n o t   i n   r e p o )   [ % s ] \ n " ,  
-                                                   i n _ o u t _ I D - > t o S t r i n g ( ) . c _ s t r ( ) ) ;  
-                 r e t u r n   i n _ o u t _ I D ;  
-         }  
- }  
-  
- v o i d   s e t u p T o o l s ( s t d : : v e c t o r < c o n s t   R e p o s i t o r y I D * > &   i t e m s )   {  
- }  
-  
- v o i d   W o r l d I n v e n t o r y R a n d o m i s a t i o n : : i n i t i a l i z e ( S c e n a r i o   s c e n ,   c o n s t   D e f a u l t I t e m P o o l *   c o n s t   d e f a u l t _ p o o l )   {  
-  
-         s t d : : v e c t o r < c o n s t   R e p o s i t o r y I D * >   n e w _ i t e m _ p o o l ;  
-  
-         / /   K e y   a n d   q u e s t   i t e m s  
-         d e f a u l t _ p o o l - > g e t ( n e w _ i t e m _ p o o l ,   & I t e m : : i s E s s e n t i a l ) ;  
-         u n s i g n e d   i n t   e s s e n t i a l _ i t e m _ c o u n t   =   n e w _ i t e m _ p o o l . s i z e ( ) ;  
-  
-         / /   T o o l   i t e m s  
-         / /   T O D O :   f a c t o r   t h i s   o u t   o f   i n i t  
-         a u t o   c r o w b a r   =   r e p o . g e t S t a b l e P o i n t e r ( R e p o s i t o r y I D ( " 0 1 e d 6 d 1 5 - e 2 6 e - 4 3 6 2 - b 1 a 6 - 3 6 3 6 8 4 a 7 d 0 f d " ) ) ;  
-         a u t o   s c r e w d r i v e r   =   r e p o . g e t S t a b l e P o i n t e r ( R e p o s i t o r y I D ( " 1 2 c b 6 b 5 1 - a 6 d d - 4 b f 5 - 9 6 5 3 - 0 a b 7 2 7 8 2 0 c a c " ) ) ;  
-         a u t o   w r e n c h   =   r e p o . g e t S t a b l e P o i n t e r ( R e p o s i t o r y I D ( " 6 a d d d f 7 e - 6 8 7 9 - 4 d 5 1 - a 7 e 2 - 6 a 2 5 f f d c a 6 a e " ) ) ;  
-  
-         a u t o   a d d O r i g i n a l N u m b e r O f I t e m s   =   [ d e f a u l t _ p o o l ,   & n e w _ i t e m _ p o o l ] ( c o n s t   R e p o s i t o r y I D *   i d )   {  
-                 a u t o   c n t   =   d e f a u l t _ p o o l - > g e t C o u n t ( * i d ) ;  
-                 f o r ( i n t   i   =   0 ;   i   <   c n t ;   + + i )  
-                         n e w _ i t e m _ p o o l . p u s h _ b a c k ( i d ) ;  
-         } ;  
-  
-         a d d O r i g i n a l N u m b e r O f I t e m s ( c r o w b a r ) ;  
-         a d d O r i g i n a l N u m b e r O f I t e m s ( s c r e w d r i v e r ) ;  
-         a d d O r i g i n a l N u m b e r O f I t e m s ( w r e n c h ) ;  
-  
-         / /   F i l l   r e m a i n i n g   s l o t s   w i t h   r a n d o m   i t e m s  
-         s i z e _ t   d e f a u l t _ i t e m _ p o o l _ w e a p o n _ c o u n t   =   d e f a u l t _ p o o l - > g e t C o u n t ( & I t e m : : i s W e a p o n ) ;  
-         i n t   d e f a u l t _ i t e m _ p o o l _ s i z e   =   d e f a u l t _ p o o l - > s i z e ( ) ;  
-         u n s i g n e d   i n t   r a n d o m _ i t e m _ c o u n t   =   d e f a u l t _ i t e m _ p o o l _ s i z e   -   n e w _ i t e m _ p o o l . s i z e ( )   -   d e f a u l t _ i t e m _ p o o l _ w e a p o n _ c o u n t ;  
-  
-         r e p o . g e t R a n d o m ( n e w _ i t e m _ p o o l ,   r a n d o m _ i t e m _ c o u n t ,   & I t e m : : i s N o t E s s e n t i a l A n d N o t W e a p o n ) ;  
-  
-         / /   S h u f f l e   i t e m   p o o l  
-         s t d : : s h u f f l e ( n e w _ i t e m _ p o o l . b e g i n ( ) ,   n e w _ i t e m _ p o o l . e n d ( ) ,   * R N G : : i n s t ( ) . g e t E n g i n e ( ) ) ;  
-  
-         / /   I n s e r t   w e a p o n s  
-         s t d : : v e c t o r < c o n s t   R e p o s i t o r y I D * >   w e a p o n s ;  
-         r e p o . g e t R a n d o m ( w e a p o n s ,   d e f a u l t _ i t e m _ p o o l _ w e a p o n _ c o u n t ,   & I t e m : : i s W e a p o n ) ;  
-  
-         s t d : : v e c t o r < i n t >   w e a p o n _ s l o t s ;  
-         d e f a u l t _ p o o l - > g e t P o s i t i o n ( w e a p o n _ s l o t s ,   & I t e m : : i s W e a p o n ) ;  
-         f o r ( i n t   i   =   0 ;   i   <   w e a p o n _ s l o t s . s i z e ( ) ;   i + + )   {  
-                 n e w _ i t e m _ p o o l . i n s e r t ( n e w _ i t e m _ p o o l . b e g i n ( )   +   w e a p o n _ s l o t s [ i ] ,   w e a p o n s [ i ] ) ;  
-         }  
-  
-         / /   f i l l   q u e u e  
-         f o r ( c o n s t   a u t o &   i d   :   n e w _ i t e m _ p o o l )  
-                 i t e m _ q u e u e . p u s h ( i d ) ;  
-  
-         / /   T O D O :   M o v e   t h i s   p r i n t   c o d e  
-         C o n s o l e : : l o g ( " I t e m P o o l   r e p o r t : \ n " ) ;  
-         C o n s o l e : : l o g ( " t o t a l   s i z e :   % d ( % d ) \ n " ,   d e f a u l t _ i t e m _ p o o l _ s i z e ,   s t a t i c _ c a s t < i n t > ( n e w _ i t e m _ p o o l . s i z e ( ) ) ) ;  
-         C o n s o l e : : l o g ( " \ t e s s e n t i a l s :   % d \ n " ,   e s s e n t i a l _ i t e m _ c o u n t ) ;  
-         C o n s o l e : : l o g ( " \ t w e a p o n s :   % d \ n " ,   s t a t i c _ c a s t < i n t > ( d e f a u l t _ i t e m _ p o o l _ w e a p o n _ c o u n t ) ) ;  
-         C o n s o l e : : l o g ( " \ t r a n d o m :   % d \ n " ,   r a n d o m _ i t e m _ c o u n t ) ;  
-         C o n s o l e : : l o g ( " \ n " ) ;  
- }  
-  
- c o n s t   R e p o s i t o r y I D *   O o p s A l l E x p l o s i v e s W o r l d I n v e n t o r y R a n d o m i z a t i o n : : r a n d o m i z e ( c o n s t   R e p o s i t o r y I D *   i n _ o u t _ I D )   {  
-         r e t u r n   W o r l d I n v e n t o r y R a n d o m i s a t i o n : : r a n d o m i z e ( i n _ o u t _ I D ) ;  
- }  
-  
- v o i d   O o p s A l l E x p l o s i v e s W o r l d I n v e n t o r y R a n d o m i z a t i o n : : i n i t i a l i z e ( S c e n a r i o   s c e n ,   c o n s t   D e f a u l t I t e m P o o l *   c o n s t   d e f a u l t _ p o o l )   {  
-         s t d : : v e c t o r < c o n s t   R e p o s i t o r y I D * >   n e w _ i t e m _ p o o l ;  
-  
-         / /   K e y   a n d   q u e s t   i t e m s  
-         d e f a u l t _ p o o l - > g e t ( n e w _ i t e m _ p o o l ,   & I t e m : : i s E s s e n t i a l ) ;  
-         u n s i g n e d   i n t   e s s e n t i a l _ i t e m _ c o u n t   =   n e w _ i t e m _ p o o l . s i z e ( ) ;  
-  
-         s i z e _ t   d e f a u l t _ i t e m _ p o o l _ w e a p o n _ c o u n t   =   d e f a u l t _ p o o l - > g e t C o u n t ( & I t e m : : i s W e a p o n ) ;  
-         i n t   d e f a u l t _ i t e m _ p o o l _ s i z e   =   d e f a u l t _ p o o l - > s i z e ( ) ;  
-         u n s i g n e d   i n t   r a n d o m _ i t e m _ c o u n t   =   d e f a u l t _ i t e m _ p o o l _ s i z e   -   n e w _ i t e m _ p o o l . s i z e ( )   -   d e f a u l t _ i t e m _ p o o l _ w e a p o n _ c o u n t ;  
-  
-         r e p o . g e t R a n d o m ( n e w _ i t e m _ p o o l ,   r a n d o m _ i t e m _ c o u n t ,   [ ] ( I t e m   i t )   {  
-                 r e t u r n   i t . s t r i n g ( )   = =   " O c t a n e   B o o s t e r "   | |   i t . s t r i n g ( )   = =   " E x p l o s i v e   S n o w   G l o b e " ;  
-         } ) ;  
-  
-         / /   S h u f f l e   i t e m   p o o l  
-         s t d : : s h u f f l e ( n e w _ i t e m _ p o o l . b e g i n ( ) ,   n e w _ i t e m _ p o o l . e n d ( ) ,   * R N G : : i n s t ( ) . g e t E n g i n e ( ) ) ;  
-  
-         / /   I n s e r t   w e a p o n s  
-         s t d : : v e c t o r < c o n s t   R e p o s i t o r y I D * >   w e a p o n s ;  
-         r e p o . g e t R a n d o m ( w e a p o n s ,   d e f a u l t _ i t e m _ p o o l _ w e a p o n _ c o u n t ,   & I t e m : : i s E x p l o s i v e ) ;  
-  
-         s t d : : v e c t o r < i n t >   w e a p o n _ s l o t s ;  
-         d e f a u l t _ p o o l - > g e t P o s i t i o n ( w e a p o n _ s l o t s ,   & I t e m : : i s W e a p o n ) ;  
-         f o r ( i n t   i   =   0 ;   i   <   w e a p o n _ s l o t s . s i z e ( ) ;   i + + )   {  
-                 n e w _ i t e m _ p o o l . i n s e r t ( n e w _ i t e m _ p o o l . b e g i n ( )   +   w e a p o n _ s l o t s [ i ] ,   w e a p o n s [ i ] ) ;  
-         }  
-  
-         / /   f i l l   q u e u e  
-         f o r ( c o n s t   a u t o &   i d   :   n e w _ i t e m _ p o o l )  
-                 i t e m _ q u e u e . p u s h ( i d ) ;  
-  
-         / /   T O D O :   M o v e   t h i s   p r i n t   c o d e  
-         C o n s o l e : : l o g ( " I t e m P o o l   r e p o r t : \ n " ) ;  
-         C o n s o l e : : l o g ( " t o t a l   s i z e :   % d ( % d ) \ n " ,   d e f a u l t _ i t e m _ p o o l _ s i z e ,   s t a t i c _ c a s t < i n t > ( n e w _ i t e m _ p o o l . s i z e ( ) ) ) ;  
-         C o n s o l e : : l o g ( " \ t e s s e n t i a l s :   % d \ n " ,   e s s e n t i a l _ i t e m _ c o u n t ) ;  
-         C o n s o l e : : l o g ( " \ t w e a p o n s :   % d \ n " ,   s t a t i c _ c a s t < i n t > ( d e f a u l t _ i t e m _ p o o l _ w e a p o n _ c o u n t ) ) ;  
-         C o n s o l e : : l o g ( " \ t r a n d o m :   % d \ n " ,   r a n d o m _ i t e m _ c o u n t ) ;  
-         C o n s o l e : : l o g ( " \ n " ) ;  
- }  
-  
- / /   T O D O :   f a c t o r   t h i s   f n  
- c o n s t   R e p o s i t o r y I D *   N P C I t e m R a n d o m i s a t i o n : : r a n d o m i z e ( c o n s t   R e p o s i t o r y I D *   i n _ o u t _ I D )   {  
-         i f ( ! r e p o . c o n t a i n s ( * i n _ o u t _ I D ) )   {  
-                 C o n s o l e : : l o g ( " N P C I t e m R a n d o m i s a t i o n : : r a n d o m i z e :   s k i p p e d   ( n o t   i n   r e p o )   [ % s ] \ n " ,  
-                                           i n _ o u t _ I D - > t o S t r i n g ( ) . c _ s t r ( ) ) ;  
-                 r e t u r n   i n _ o u t _ I D ;  
-         }  
-  
-         a u t o   i n _ i t e m   =   r e p o . g e t I t e m ( * i n _ o u t _ I D ) ;  
-  
-         / /   S p e c i a l   c a s e   f o r   f l a s h   g r e n a d e s :   ~ 1 0 %   b a n a n a   c h a n c e  
-         i f ( ( * i n _ o u t _ I D   = =   R e p o s i t o r y I D ( " 0 4 2 f a e 7 b - f e 9 e - 4 a 8 3 - a c 7 b - 5 c 9 1 4 a 7 1 b 2 c a " )   & &  
-                 C o n f i g : : r a n d o m i z e N P C G r e n a d e s   & &   ( r a n d ( )   %   1 0   = =   0 ) ) )  
-                 r e t u r n   r e p o . g e t S t a b l e P o i n t e r ( R e p o s i t o r y I D ( " 9 0 3 d 2 7 3 c - c 7 5 0 - 4 4 1 d - 9 1 6 a - 3 1 5 5 7 f e a 3 3 8 2 " ) ) ;   / /   B a n a n a  
-  
-         / /   O n l y   N P C   w e a p o n s   a r e   r a n d o m i z e d   h e r e ,   r e t u r n   o r i g i n a l   i t e m   i f   i t e m   i s n ' t   a   w e a p o n  
-         i f ( ! i n _ i t e m - > i s W e a p o n ( ) )   {  
-                 C o n s o l e : : l o g ( " N P C I t e m R a n d o m i s a t i o n : : r a n d o m i z e :   s k i p p e d   ( n o t   a   w e a p o n )   [ % s ] \ n " ,  
-                                           r e p o . g e t I t e m ( * i n _ o u t _ I D ) - > s t r i n g ( ) . c _ s t r ( ) ) ;  
-                 r e t u r n   i n _ o u t _ I D ;  
-         }  
-  
-         a u t o   s a m e T y p e   =   [ & i n _ i t e m ] ( c o n s t   I t e m &   i t e m )   {   r e t u r n   i n _ i t e m - > g e t T y p e ( )   = =   i t e m . g e t T y p e ( ) ;   } ;  
-  
-         a u t o   r a n d o m i z e d _ i t e m   =   r e p o . g e t R a n d o m ( s a m e T y p e ) ;  
-         C o n s o l e : : l o g ( " N P C I t e m R a n d o m i s a t i o n : : r a n d o m i z e :   % s   - >   % s \ n " ,   r e p o . g e t I t e m ( * i n _ o u t _ I D ) - > s t r i n g ( ) . c _ s t r ( ) ,  
-                                   r e p o . g e t I t e m ( * r a n d o m i z e d _ i t e m ) - > s t r i n g ( ) . c _ s t r ( ) ) ;  
-  
-         r e t u r n   r a n d o m i z e d _ i t e m ;  
- }  
-  
- c o n s t   R e p o s i t o r y I D *   H e r o I n v e n t o r y R a n d o m i s a t i o n : : r a n d o m i z e ( c o n s t   R e p o s i t o r y I D *   i n _ o u t _ I D )   {  
-         C o n s o l e : : l o g ( " H e r o I n v e n t o r y R a n d o m i s a t i o n : : r a n d o m i z e   e n t e r e d   w i t h   % s \ n " ,   i n _ o u t _ I D - > t o S t r i n g ( ) . c _ s t r ( ) ) ;  
-         i f ( ! r e p o . c o n t a i n s ( * i n _ o u t _ I D ) )   {  
-                 C o n s o l e : : l o g ( " H e r o I n v e n t o r y R a n d o m i s a t i o n : : r a n d o m i z e :   s k i p p e d   ( n o t   i n   r e p o )   [ % s ] \ n " ,  
-                                           i n _ o u t _ I D - > t o S t r i n g ( ) . c _ s t r ( ) ) ;  
-                 r e t u r n   i n _ o u t _ I D ;  
-         }  
-  
-         a u t o   i n _ i t e m   =   r e p o . g e t I t e m ( * i n _ o u t _ I D ) ;  
-  
-         a u t o   s a m e T y p e   =   [ & i n _ i t e m ] ( c o n s t   I t e m &   i t e m )   {   r e t u r n   i n _ i t e m - > g e t T y p e ( )   = =   i t e m . g e t T y p e ( ) ;   } ;  
-  
-         a u t o   r a n d o m i z e d _ i t e m   =   r e p o . g e t R a n d o m ( s a m e T y p e ) ;  
-         C o n s o l e : : l o g ( " H e r o I n v e n t o r y R a n d o m i s a t i o n : : r a n d o m i z e :   % s   - >   % s \ n " ,  
-                                   r e p o . g e t I t e m ( * i n _ o u t _ I D ) - > s t r i n g ( ) . c _ s t r ( ) ,  
-                                   r e p o . g e t I t e m ( * r a n d o m i z e d _ i t e m ) - > s t r i n g ( ) . c _ s t r ( ) ) ;  
-  
-         r e t u r n   r a n d o m i z e d _ i t e m ;  
- } ;  
-  
- c o n s t   R e p o s i t o r y I D *   S t a s h I n v e n t o r y R a n d o m i s a t i o n : : r a n d o m i z e ( c o n s t   R e p o s i t o r y I D *   i n _ o u t _ I D )   {  
-         i f ( ! r e p o . c o n t a i n s ( * i n _ o u t _ I D ) )   {  
-                 C o n s o l e : : l o g ( " S t a s h I n v e n t o r y R a n d o m i s a t i o n : : r a n d o m i z e :   s k i p p e d   ( n o t   i n   r e p o )   [ % s ] \ n " ,  
-                                           i n _ o u t _ I D - > t o S t r i n g ( ) . c _ s t r ( ) ) ;  
-                 r e t u r n   i n _ o u t _ I D ;  
-         }  
-  
-         a u t o   i n _ i t e m   =   r e p o . g e t I t e m ( * i n _ o u t _ I D ) ;  
-  
-         a u t o   s a m e T y p e   =   [ & i n _ i t e m ] ( c o n s t   I t e m &   i t e m )   {   r e t u r n   i n _ i t e m - > g e t T y p e ( )   = =   i t e m . g e t T y p e ( ) ;   } ;  
-  
-         a u t o   r a n d o m i z e d _ i t e m   =   r e p o . g e t R a n d o m ( s a m e T y p e ) ;  
-         C o n s o l e : : l o g ( " S t a s h I n v e n t o r y R a n d o m i s a t i o n : : r a n d o m i z e :   % s   - >   % s \ n " ,  
-                                   r e p o . g e t I t e m ( * i n _ o u t _ I D ) - > s t r i n g ( ) . c _ s t r ( ) ,  
-                                   r e p o . g e t I t e m ( * r a n d o m i z e d _ i t e m ) - > s t r i n g ( ) . c _ s t r ( ) ) ;  
-  
-         r e t u r n   r a n d o m i z e d _ i t e m ;  
- } ;  
-  
- R a n d o m i z e r : : R a n d o m i z e r ( R a n d o m i s a t i o n S t r a t e g y *   s t r a t e g y _ )   {  
-         s t r a t e g y   =   s t d : : u n i q u e _ p t r < R a n d o m i s a t i o n S t r a t e g y > ( s t r a t e g y _ ) ;  
- }  
-  
- c o n s t   R e p o s i t o r y I D *   R a n d o m i z e r : : r a n d o m i z e ( c o n s t   R e p o s i t o r y I D *   i d )   {  
-         / /   p r i n t f ( " % s \ n " ,   i d - > t o S t r i n g ( ) . c _ s t r ( ) ) ;  
-         i f ( e n a b l e d )  
-                 r e t u r n   s t r a t e g y - > r a n d o m i z e ( i d ) ;  
-         e l s e  
-                 r e t u r n   i d ;  
- }  
-  
- v o i d   R a n d o m i z e r : : i n i t i a l i z e ( S c e n a r i o   s c e n ,   c o n s t   D e f a u l t I t e m P o o l *   c o n s t   d e f a u l t _ p o o l )   {  
-         e n a b l e d   =   t r u e ;  
-         s t r a t e g y - > i n i t i a l i z e ( s c e n ,   d e f a u l t _ p o o l ) ;  
- }  
-  
- v o i d   R a n d o m i z e r : : d i s a b l e ( )   {  
-         e n a b l e d   =   f a l s e ;  
- }  
-  
- c o n s t   R e p o s i t o r y I D *   I d e n t i t y R a n d o m i s a t i o n : : r a n d o m i z e ( c o n s t   R e p o s i t o r y I D *   i n _ o u t _ I D )   {  
- # i f d e f   D E F A U L T P O O L E X P O R T  
-         D e f a u l t P o o l E x p o r t : : p u s h ( i n _ o u t _ I D - > t o S t r i n g ( ) ) ;  
- # e n d i f  
-         r e t u r n   i n _ o u t _ I D ;  
- }  
-  
- c o n s t   R e p o s i t o r y I D *   U n r e s t r i c t e d N P C R a n d o m i z a t i o n : : r a n d o m i z e ( c o n s t   R e p o s i t o r y I D *   i n _ o u t _ I D )   {  
-         i f ( ! r e p o . c o n t a i n s ( * i n _ o u t _ I D ) )   {  
-                 C o n s o l e : : l o g ( " N P C I t e m R a n d o m i s a t i o n : : r a n d o m i z e :   s k i p p e d   ( n o t   i n   r e p o )   [ % s ] \ n " ,  
-                                           i n _ o u t _ I D - > t o S t r i n g ( ) . c _ s t r ( ) ) ;  
-                 r e t u r n   i n _ o u t _ I D ;  
-         }  
-  
-         a u t o   i n _ i t e m   =   r e p o . g e t I t e m ( * i n _ o u t _ I D ) ;  
-  
-         / /   f l a s h   g r e n a d e s   - >   f r a g   g r e n a d e s  
-         i f ( ( * i n _ o u t _ I D   = =   R e p o s i t o r y I D ( " 0 4 2 f a e 7 b - f e 9 e - 4 a 8 3 - a c 7 b - 5 c 9 1 4 a 7 1 b 2 c a " ) )   & &   C o n f i g : : r a n d o m i z e N P C G r e n a d e s )  
-                 r e t u r n   r e p o . g e t S t a b l e P o i n t e r ( R e p o s i t o r y I D ( " 3 f 9 c f 0 3 f - b 8 4 f - 4 4 1 9 - b 8 3 1 - 4 7 0 4 c f f 9 7 7 5 c " ) ) ;  
-  
-         / /   O n l y   N P C   w e a p o n s   a r e   r a n d o m i z e d   h e r e ,   r e t u r n   o r i g i n a l   i t e m   i f   i t e m   i s n ' t   a   w e a p o n  
-         i f ( ! i n _ i t e m - > i s W e a p o n ( ) )   {  
-                 C o n s o l e : : l o g ( " N P C I t e m R a n d o m i s a t i o n : : r a n d o m i z e :   s k i p p e d   ( n o t   a   w e a p o n )   [ % s ] \ n " ,  
-                                           r e p o . g e t I t e m ( * i n _ o u t _ I D ) - > s t r i n g ( ) . c _ s t r ( ) ) ;  
-                 r e t u r n   i n _ o u t _ I D ;  
-         }  
-  
-         a u t o   r a n d o m i z e d _ i t e m   =   r e p o . g e t R a n d o m ( & I t e m : : i s W e a p o n ) ;  
-         C o n s o l e : : l o g ( " N P C I t e m R a n d o m i s a t i o n : : r a n d o m i z e :   % s   - >   % s \ n " ,   r e p o . g e t I t e m ( * i n _ o u t _ I D ) - > s t r i n g ( ) . c _ s t r ( ) ,  
-                                   r e p o . g e t I t e m ( * r a n d o m i z e d _ i t e m ) - > s t r i n g ( ) . c _ s t r ( ) ) ;  
-  
-         r e t u r n   r a n d o m i z e d _ i t e m ;  
- }  
-  
- c o n s t   R e p o s i t o r y I D *   S l e e p y N P C R a n d o m i z a t i o n : : r a n d o m i z e ( c o n s t   R e p o s i t o r y I D *   i n _ o u t _ I D )   {  
-         i f ( ! r e p o . c o n t a i n s ( * i n _ o u t _ I D ) )   {  
-                 C o n s o l e : : l o g ( " S l e e p y N P C R a n d o m i z a t i o n : : r a n d o m i z e :   s k i p p e d   ( n o t   i n   r e p o )   [ % s ] \ n " ,  
-                                           i n _ o u t _ I D - > t o S t r i n g ( ) . c _ s t r ( ) ) ;  
-                 r e t u r n   i n _ o u t _ I D ;  
-         }  
-  
-         a u t o   i n _ i t e m   =   r e p o . g e t I t e m ( * i n _ o u t _ I D ) ;  
-  
-         i f ( ! i n _ i t e m - > i s W e a p o n ( ) )   {  
-                 r e t u r n   i n _ o u t _ I D ;  
-         }  
-  
-         a u t o   r a n d o m i z e d _ i t e m   =   r e p o . g e t R a n d o m ( [ ] ( I t e m   i t )   {   r e t u r n   i t . s t r i n g ( )   = =   " ( T o o l )   C o i n   C u r e " ;   } ) ;  
-         C o n s o l e : : l o g ( " N P C I t e m R a n d o m i s a t i o n : : r a n d o m i z e :   % s   - >   % s \ n " ,   r e p o . g e t I t e m ( * i n _ o u t _ I D ) - > s t r i n g ( ) . c _ s t r ( ) ,  
-                                   r e p o . g e t I t e m ( * r a n d o m i z e d _ i t e m ) - > s t r i n g ( ) . c _ s t r ( ) ) ;  
-  
-         r e t u r n   r a n d o m i z e d _ i t e m ;  
- }  
- 
\ No newline at end of file
+#include "Randomizer.h"
+#include "Config.h"
+#include "Console.h"
+#include "DefaultItemPool.h"
+#include "Item.h"
+#include "PlanCache.h"
+#include "RNG.h"
+#include "Repository.h"
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <span>
+#ifdef DEFAULTPOOLEXPORT
+#include "DefaultPoolExport.h"
+#endif
+
+RandomisationStrategy::RandomisationStrategy() : repo(RandomDrawRepository::inst()) {
+}
+
+void RandomisationStrategy::initialize(Scenario, const DefaultItemPool* const) {
+}
+
+bool RandomisationStrategy::hasRequiredItems() const {
+    return true;
+}
+
+void RandomisationStrategy::setSceneMemory(std::pmr::memory_resource* memory) {
+    scene_memory = memory;
+}
+
+void RandomisationStrategy::setBorrowedPool(bool borrowed) {
+    borrowed_pool = borrowed;
+}
+
+const RepositoryID* WorldInventoryRandomisation::randomize(const RepositoryID* in_out_ID) {
+    auto in_handle = repo.getHandle(*in_out_ID);
+    if(in_handle && keyed_plan) {
+        const RepositoryID* id = nullptr;
+        if(!plan.take(*in_handle, id)) {
+            LOG_DEBUG("WorldInventoryRandomisation::randomize: skipped (no position left for "
+                      "item) [%s]\n",
+                      in_out_ID->text().c_str());
+            return in_out_ID;
+        }
+        // Slots the plan couldn't fill keep their original item
+        if(!id)
+            id = in_out_ID;
+        LOG_DEBUG("WorldInventoryRandomisation::randomize: %d: %s -> %s\n",
+                  static_cast<int>(plan.remaining()), repo.getItem(*in_handle).c_str(),
+                  repo.getItem(*id)->c_str());
+        return id;
+    } else if(in_handle && plan.remaining()) {
+        const RepositoryID* id = plan.next();
+        // Slots no item could be drawn for keep their original item
+        if(!id)
+            id = in_out_ID;
+        LOG_DEBUG("WorldInventoryRandomisation::randomize: %d: %s -> %s\n",
+                  static_cast<int>(plan.remaining()), repo.getItem(*in_handle).c_str(),
+                  repo.getItem(*id)->c_str());
+        return id;
+    } else {
+        if(!plan.remaining())
+            LOG_DEBUG("WorldInventoryRandomisation::randomize: skipped (plan exhausted) [%s]\n",
+                      in_out_ID->text().c_str());
+        else
+            LOG_DEBUG("WorldInventoryRandomisation::randomize: skipped (not in repo) [%s]\n",
+                      in_out_ID->text().c_str());
+        return in_out_ID;
+    }
+}
+
+void WorldInventoryRandomisation::initialize(Scenario scen, const DefaultItemPool* const default_pool) {
+    // Tool items
+    // TODO: factor this out of init
+    auto crowbar = repo.getStablePointer(WellKnownItem::CROWBAR);
+    auto screwdriver = repo.getStablePointer(WellKnownItem::SCREWDRIVER);
+    auto wrench = repo.getStablePointer(WellKnownItem::WRENCH);
+
+    std::pmr::vector<const RepositoryID*> tools(scene_memory);
+    auto addOriginalNumberOfItems = [default_pool, &tools](const RepositoryID* id) {
+        auto cnt = default_pool->getCount(*id);
+        for(int i = 0; i < cnt; ++i)
+            tools.push_back(id);
+    };
+
+    addOriginalNumberOfItems(crowbar);
+    addOriginalNumberOfItems(screwdriver);
+    addOriginalNumberOfItems(wrench);
+
+    buildItemPlan(scen, default_pool, repo.index().byPredicate(&Item::isNotEssentialAndNotWeapon),
+                  repo.index().byPredicate(&Item::isWeapon), tools);
+}
+
+bool WorldInventoryRandomisation::hasRequiredItems() const {
+    return repo.getHandle(WellKnownItem::CROWBAR) && repo.getHandle(WellKnownItem::SCREWDRIVER) &&
+           repo.getHandle(WellKnownItem::WRENCH);
+}
+
+void WorldInventoryRandomisation::buildItemPlan(Scenario scen,
+                                                const DefaultItemPool* const default_pool,
+                                                const CandidateSet& random_items,
+                                                const CandidateSet& weapons,
+                                                std::span<const RepositoryID* const> fixed_items) {
+    // With a fixed seed the plan is the same as on the last load of this scenario
+    auto& rng = *RNG::inst().getEngine();
+    const auto& config = Config::current();
+    // Positions of a borrowed pool don't match the order the scene spawns its items in
+    keyed_plan = config.orderIndependentWorldItems || borrowed_pool;
+    std::pmr::vector<ItemHandle> originals(scene_memory);
+    if(keyed_plan) {
+        originals.resize(default_pool->size());
+        default_pool->getHandles(originals);
+    }
+
+    auto cache_key = PlanCache::key(scen, repo, *default_pool, keyed_plan);
+    if(cache_key && PlanCache::load(*cache_key, repo, plan, rng)) {
+        if(keyed_plan)
+            plan.indexByOriginal(originals);
+        LOG_INFO("ItemPool: %d slots restored from the plan cache\n",
+                 static_cast<int>(plan.remaining()));
+        return;
+    }
+
+    auto essential_item_count = default_pool->getCount(&Item::isEssential);
+    size_t default_item_pool_weapon_count = default_pool->getCount(&Item::isWeapon);
+    int default_item_pool_size = default_pool->size();
+    unsigned int random_item_count = default_item_pool_size - essential_item_count -
+                                     fixed_items.size() - default_item_pool_weapon_count;
+
+    plan.reset(essential_item_count + fixed_items.size() + random_item_count +
+               default_item_pool_weapon_count);
+
+    // Key and quest items. A keyed plan keeps them at their own positions instead.
+    if(!keyed_plan)
+        default_pool->get(plan.appendFree(essential_item_count), &Item::isEssential);
+    std::ranges::copy(fixed_items, plan.appendFree(fixed_items.size()).begin());
+
+    // Fill remaining slots with random items
+    if(random_items.empty())
+        LOG_INFO("WorldInventoryRandomisation::buildItemPlan: no candidates for random items\n");
+
+    // Spread random items over as many distinct items as possible unless weights are configured.
+    // Weighted draws follow the weights and only respect the repeat limit.
+    auto first_random_item = plan.size();
+    auto random_slots = plan.appendFree(random_item_count);
+    size_t drawn;
+    if(repo.hasUniformWeights())
+        drawn = repo.getDistinctRandom(random_slots, random_items, config.worldItemMaxRepeats);
+    else
+        drawn = repo.getWeightedRandom(random_slots, random_items, config.worldItemMaxRepeats);
+    plan.truncate(first_random_item + drawn);
+    if(drawn < random_item_count && !random_items.empty())
+        LOG_INFO("WorldInventoryRandomisation::buildItemPlan: repeat limit reached, %d slots "
+                 "stay unchanged\n",
+                 static_cast<int>(random_item_count - drawn));
+
+    auto weapon_count = weapons.empty() ? 0 : default_item_pool_weapon_count;
+    if(keyed_plan) {
+        // Every position gets a slot, so slots that couldn't be filled become empty slots which
+        // keep their original item. Essential items and weapons then land exactly at their
+        // positions, as the layout puts fixed slots at their position when enough free items
+        // precede them.
+        auto free_slots = plan.appendFree(fixed_items.size() + random_item_count - plan.size());
+        std::fill(free_slots.begin(), free_slots.end(), nullptr);
+
+        auto essential_positions = default_pool->getPosition(&Item::isEssential);
+        auto weapon_positions = default_pool->getPosition(&Item::isWeapon);
+        std::pmr::vector<int> fixed_positions(scene_memory);
+        fixed_positions.reserve(essential_positions.size() + weapon_positions.size());
+        std::ranges::merge(essential_positions, weapon_positions,
+                           std::back_inserter(fixed_positions));
+
+        size_t next_fixed = 0, next_essential = 0;
+        plan.layout(fixed_positions, fixed_positions.size(), rng, [&]() -> const RepositoryID* {
+            auto pos = fixed_positions[next_fixed++];
+            if(next_essential < essential_positions.size() &&
+               essential_positions[next_essential] == pos) {
+                ++next_essential;
+                return repo.getStablePointer(originals[pos]);
+            }
+            return weapons.empty() ? nullptr : repo.getWeightedRandom(weapons);
+        });
+        plan.indexByOriginal(originals);
+    } else {
+        // Shuffle the item pool and put weapons back into their original slots
+        plan.layout(default_pool->getPosition(&Item::isWeapon), weapon_count, rng,
+                    [&] { return repo.getWeightedRandom(weapons); });
+    }
+
+    if(cache_key)
+        PlanCache::store(*cache_key, plan, rng);
+
+    // TODO: Move this print code
+    LOG_INFO("ItemPool report:\n");
+    LOG_INFO("total size: %d(%d)\n", default_item_pool_size, static_cast<int>(plan.remaining()));
+    LOG_INFO("\tessentials: %d\n", static_cast<int>(essential_item_count));
+    LOG_INFO("\tweapons: %d\n", static_cast<int>(weapon_count));
+    LOG_INFO("\trandom: %d\n", random_item_count);
+    LOG_INFO("\n");
+}
+
+const RepositoryID* OopsAllExplosivesWorldInventoryRandomization::randomize(const RepositoryID* in_out_ID) {
+    return WorldInventoryRandomisation::randomize(in_out_ID);
+}
+
+void OopsAllExplosivesWorldInventoryRandomization::initialize(Scenario scen, const DefaultItemPool* const default_pool) {
+    buildItemPlan(scen, default_pool, repo.index().byGroup(WellKnownGroup::EXPLOSIVE_GIFTS),
+                  repo.index().byPredicate(&Item::isExplosive));
+}
+
+bool OopsAllExplosivesWorldInventoryRandomization::hasRequiredItems() const {
+    return !repo.index().byGroup(WellKnownGroup::EXPLOSIVE_GIFTS).empty();
+}
+
+void CustomWorldInventoryRandomization::initialize(Scenario scen,
+                                                   const DefaultItemPool* const default_pool) {
+    if(!random_items) {
+        const auto& config = Config::current();
+        const auto& allowed =
+        filter.get(repo, config.customWorldAllowedWords, config.customWorldIgnoredWords);
+        auto& index = repo.index();
+
+        // Weapon slots prefer allowed weapons but fall back to any allowed item
+        random_items = index.fromBits(allowed.bits & index.byPredicate(&Item::isNotEssential).bits);
+        weapons = index.fromBits(allowed.bits & index.byPredicate(&Item::isWeapon).bits);
+        if(weapons->empty())
+            weapons = random_items;
+    }
+
+    buildItemPlan(scen, default_pool, *random_items, *weapons);
+}
+
+bool CustomWorldInventoryRandomization::hasRequiredItems() const {
+    return true;
+}
+
+bool NPCItemRandomisation::hasRequiredItems() const {
+    return repo.getHandle(WellKnownItem::FLASH_GRENADE) && repo.getHandle(WellKnownItem::BANANA);
+}
+
+// TODO: factor this fn
+const RepositoryID* NPCItemRandomisation::randomize(const RepositoryID* in_out_ID) {
+    auto in_handle = repo.getHandle(*in_out_ID);
+    if(!in_handle) {
+        LOG_DEBUG("NPCItemRandomisation::randomize: skipped (not in repo) [%s]\n",
+                  in_out_ID->text().c_str());
+        return in_out_ID;
+    }
+
+    auto in_item = &repo.getItem(*in_handle);
+
+    // Special case for flash grenades: ~10% banana chance
+    if(*in_handle == repo.getHandle(WellKnownItem::FLASH_GRENADE) &&
+       Config::current().randomizeNPCGrenades && (rand() % 10 == 0))
+        return repo.getStablePointer(WellKnownItem::BANANA);
+
+    // Only NPC weapons are randomized here, return original item if item isn't a weapon
+    if(!in_item->isWeapon()) {
+        LOG_DEBUG("NPCItemRandomisation::randomize: skipped (not a weapon) [%s]\n",
+                  in_item->c_str());
+        return in_out_ID;
+    }
+
+    auto randomized_item = repo.getWeightedRandom(repo.index().byIcon(in_item->getType()));
+    if(randomized_item == nullptr)
+        return in_out_ID;
+
+    LOG_DEBUG("NPCItemRandomisation::randomize: %s -> %s\n", in_item->c_str(),
+              repo.getItem(*randomized_item)->c_str());
+
+    return randomized_item;
+}
+
+const RepositoryID* HeroInventoryRandomisation::randomize(const RepositoryID* in_out_ID) {
+    LOG_DEBUG("HeroInventoryRandomisation::randomize entered with %s\n", in_out_ID->text().c_str());
+    auto in_handle = repo.getHandle(*in_out_ID);
+    if(!in_handle) {
+        LOG_DEBUG("HeroInventoryRandomisation::randomize: skipped (not in repo) [%s]\n",
+                  in_out_ID->text().c_str());
+        return in_out_ID;
+    }
+
+    auto in_item = &repo.getItem(*in_handle);
+
+    auto randomized_item = repo.getWeightedRandom(repo.index().byIcon(in_item->getType()));
+    if(randomized_item == nullptr)
+        return in_out_ID;
+
+    LOG_DEBUG("HeroInventoryRandomisation::randomize: %s -> %s\n",
+              in_item->c_str(),
+              repo.getItem(*randomized_item)->c_str());
+
+    return randomized_item;
+};
+
+const RepositoryID* StashInventoryRandomisation::randomize(const RepositoryID* in_out_ID) {
+    auto in_handle = repo.getHandle(*in_out_ID);
+    if(!in_handle) {
+        LOG_DEBUG("StashInventoryRandomisation::randomize: skipped (not in repo) [%s]\n",
+                  in_out_ID->text().c_str());
+        return in_out_ID;
+    }
+
+    auto in_item = &repo.getItem(*in_handle);
+
+    auto randomized_item = repo.getWeightedRandom(repo.index().byIcon(in_item->getType()));
+    if(randomized_item == nullptr)
+        return in_out_ID;
+
+    LOG_DEBUG("StashInventoryRandomisation::randomize: %s -> %s\n",
+              in_item->c_str(),
+              repo.getItem(*randomized_item)->c_str());
+
+    return randomized_item;
+};
+
+Randomizer::Randomizer(RandomisationStrategy* strategy, std::pmr::memory_resource* scene_memory)
+: enabled(false), strategy(strategy), scene_memory(scene_memory) {
+}
+
+const RepositoryID* Randomizer::randomize(const RepositoryID* id) {
+    // printf("%s\n", id->toString().c_str());
+    if(enabled)
+        return strategy->randomize(id);
+    else
+        return id;
+}
+
+void Randomizer::initialize(Scenario scen,
+                            const DefaultItemPool* const default_pool,
+                            bool borrowed_pool) {
+    enabled = true;
+    strategy->setSceneMemory(scene_memory);
+    strategy->setBorrowedPool(borrowed_pool);
+    strategy->initialize(scen, default_pool);
+}
+
+void Randomizer::disable() {
+    enabled = false;
+}
+
+const RepositoryID* IdentityRandomisation::randomize(const RepositoryID* in_out_ID) {
+#ifdef DEFAULTPOOLEXPORT
+    DefaultPoolExport::push(in_out_ID->toString());
+#endif
+    return in_out_ID;
+}
+
+bool UnrestrictedNPCRandomization::hasRequiredItems() const {
+    return repo.getHandle(WellKnownItem::FLASH_GRENADE) &&
+           repo.getHandle(WellKnownItem::FRAG_GRENADE);
+}
+
+const RepositoryID* UnrestrictedNPCRandomization::randomize(const RepositoryID* in_out_ID) {
+    auto in_handle = repo.getHandle(*in_out_ID);
+    if(!in_handle) {
+        LOG_DEBUG("NPCItemRandomisation::randomize: skipped (not in repo) [%s]\n",
+                  in_out_ID->text().c_str());
+        return in_out_ID;
+    }
+
+    auto in_item = &repo.getItem(*in_handle);
+
+    // flash grenades -> frag grenades
+    if(*in_handle == repo.getHandle(WellKnownItem::FLASH_GRENADE) &&
+       Config::current().randomizeNPCGrenades)
+        return repo.getStablePointer(WellKnownItem::FRAG_GRENADE);
+
+    // Only NPC weapons are randomized here, return original item if item isn't a weapon
+    if(!in_item->isWeapon()) {
+        LOG_DEBUG("NPCItemRandomisation::randomize: skipped (not a weapon) [%s]\n",
+                  in_item->c_str());
+        return in_out_ID;
+    }
+
+    auto randomized_item = repo.getWeightedRandom(repo.index().byPredicate(&Item::isWeapon));
+    if(randomized_item == nullptr)
+        return in_out_ID;
+
+    LOG_DEBUG("NPCItemRandomisation::randomize: %s -> %s\n", in_item->c_str(),
+              repo.getItem(*randomized_item)->c_str());
+
+    return randomized_item;
+}
+
+bool SleepyNPCRandomization::hasRequiredItems() const {
+    return !repo.index().byGroup(WellKnownGroup::COINS).empty();
+}
+
+const RepositoryID* SleepyNPCRandomization::randomize(const RepositoryID* in_out_ID) {
+    auto in_handle = repo.getHandle(*in_out_ID);
+    if(!in_handle) {
+        LOG_DEBUG("SleepyNPCRandomization::randomize: skipped (not in repo) [%s]\n",
+                  in_out_ID->text().c_str());
+        return in_out_ID;
+    }
+
+    auto in_item = &repo.getItem(*in_handle);
+
+    if(!in_item->isWeapon()) {
+        return in_out_ID;
+    }
+
+    auto randomized_item = repo.getRandom(repo.index().byGroup(WellKnownGroup::COINS));
+    LOG_DEBUG("NPCItemRandomisation::randomize: %s -> %s\n", in_item->c_str(),
+              repo.getItem(*randomized_item)->c_str());
+
+    return randomized_item;
+}
+
+void CustomNPCRandomization::initialize(Scenario scen, const DefaultItemPool* const default_pool) {
+    const auto& config = Config::current();
+    candidates = &filter.get(repo, config.customNPCAllowedWords, config.customNPCIgnoredWords);
+}
+
+const RepositoryID* CustomNPCRandomization::randomize(const RepositoryID* in_out_ID) {
+    auto in_handle = repo.getHandle(*in_out_ID);
+    if(!in_handle) {
+        LOG_DEBUG("CustomNPCRandomization::randomize: skipped (not in repo) [%s]\n",
+                  in_out_ID->text().c_str());
+        return in_out_ID;
+    }
+
+    auto in_item = &repo.getItem(*in_handle);
+
+    // Only NPC weapons are randomized here, return original item if item isn't a weapon
+    if(!in_item->isWeapon())
+        return in_out_ID;
+
+    auto randomized_item = repo.getWeightedRandom(*candidates);
+    if(randomized_item == nullptr)
+        return in_out_ID;
+
+    LOG_DEBUG("CustomNPCRandomization::randomize: %s -> %s\n", in_item->c_str(),
+              repo.getItem(*randomized_item)->c_str());
+
+    return randomized_item;
+}
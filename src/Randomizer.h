@@ -1,34 +1,57 @@
 #pragma once
+#include <memory_resource>
+#include <optional>
+#include <span>
 #include <type_traits>
 #include <unordered_map>
-#include <queue>
 #include <random>
+#include "CustomItemFilter.h"
+#include "ItemPlan.h"
 #include "Repository.h"
-#include "..\thirdparty\json.hpp"
+#include "../thirdparty/json.hpp"
 #include "Scenario.h"
 
 
 class DefaultItemPool;
 
+//Strategies are created once per config and reused for every scene load until the config or the
+//repository changes, state derived from either can be computed once and kept in the strategy.
 class RandomisationStrategy {
 protected:
 	RandomDrawRepository& repo;
+	//Memory for scratch state of initialize(), the arena of the scene being loaded
+	std::pmr::memory_resource* scene_memory = std::pmr::get_default_resource();
+	//The default pool passed to initialize() is that of a similar scenario, not of the scene
+	//being loaded
+	bool borrowed_pool = false;
 
+public:
 	RandomisationStrategy();
+	RandomisationStrategy(const RandomisationStrategy&) = delete;
+	RandomisationStrategy& operator=(const RandomisationStrategy&) = delete;
+	virtual ~RandomisationStrategy() = default;
 
-public:
 	//Takes Repository ID and returns a new ID according to the internal randomisation strategy
 	//Item IDs that don't have a corresponding item configuration in the Repository should be skipped.
 	virtual const RepositoryID* randomize(const RepositoryID* in_out_ID) = 0;
 
 	//Called on SceneLoad. This function is intended for stateful randomisation strategies
 	//which might require knowledge of the next scene and/or default item pool of that scene
-	//to setup their internal state in preparation for item randomisation.
+	//to setup their internal state in preparation for item randomisation. All state of the
+	//previous scene has to be reset here.
 	virtual void initialize(Scenario, const DefaultItemPool* const );
+
+	//False if a well-known item or group the strategy refers to directly is missing from the
+	//repository, e.g. hidden by IgnoreList.json. The slot falls back to NONE then.
+	virtual bool hasRequiredItems() const;
+
+	void setSceneMemory(std::pmr::memory_resource* memory);
+	void setBorrowedPool(bool borrowed);
 };
 
 class IdentityRandomisation : public RandomisationStrategy {
 public:
+	using RandomisationStrategy::RandomisationStrategy;
 
 	const RepositoryID* randomize(const RepositoryID* in_out_ID) override final;
 };
@@ -37,22 +60,57 @@ public:
 //It's desiged to be as undistruptive to the game flow as possible.
 class WorldInventoryRandomisation : public RandomisationStrategy {
 protected:
-	std::queue<const RepositoryID*> item_queue;
+	//Lives as long as the strategy, so the storage of the plan is reused from scene to scene
+	ItemPlan plan;
+	//Items are replaced by looking up their original item and occurrence in the plan instead of
+	//in the order the game spawns them (the orderIndependentWorldItems setting). Always used with
+	//a borrowed pool, items of the scene that have no position in it keep their original item.
+	bool keyed_plan = false;
+
+	//Lays out the item plan: essential items and fixed_items are kept, weapon slots are filled from
+	//weapons and all remaining slots from random_items. A keyed plan keeps essential items at their
+	//own positions. With a fixed seed the plan is taken from the plan cache if it was built before.
+	void buildItemPlan(Scenario scen,
+	                   const DefaultItemPool* const default_pool,
+	                   const CandidateSet& random_items,
+	                   const CandidateSet& weapons,
+	                   std::span<const RepositoryID* const> fixed_items = {});
 
 public:
+	using RandomisationStrategy::RandomisationStrategy;
+
 	const RepositoryID* randomize(const RepositoryID* in_out_ID) override;
 	void initialize(Scenario scen, const DefaultItemPool* const default_pool) override;
+	bool hasRequiredItems() const override;
 };
 
 class OopsAllExplosivesWorldInventoryRandomization : public WorldInventoryRandomisation {
 public:
+	using WorldInventoryRandomisation::WorldInventoryRandomisation;
 	const RepositoryID* randomize(const RepositoryID* in_out_ID) override final;
 	void initialize(Scenario scen, const DefaultItemPool* const default_pool) override final;
+	bool hasRequiredItems() const override final;
+};
+
+//Randomizes world items with items matching the Custom.World word lists of the config.
+class CustomWorldInventoryRandomization : public WorldInventoryRandomisation {
+private:
+	CustomItemFilter filter;
+	//Computed on the first scene, the word lists and the repository don't change for a strategy
+	std::optional<CandidateSet> random_items;
+	std::optional<CandidateSet> weapons;
+
+public:
+	using WorldInventoryRandomisation::WorldInventoryRandomisation;
+	void initialize(Scenario scen, const DefaultItemPool* const default_pool) override final;
+	bool hasRequiredItems() const override final;
 };
 
 class NPCItemRandomisation : public RandomisationStrategy {
 public:
+	using RandomisationStrategy::RandomisationStrategy;
 	const RepositoryID* randomize(const RepositoryID* in_out_ID) override final;
+	bool hasRequiredItems() const override final;
 };
 
 /*
@@ -64,33 +122,54 @@ suitcase, pistol, distraction, poison, Container and smg.
 */
 class HeroInventoryRandomisation : public RandomisationStrategy {
 public:
+	using RandomisationStrategy::RandomisationStrategy;
 	const RepositoryID* randomize(const RepositoryID* in_out_ID) override final;
 };
 
 class StashInventoryRandomisation : public RandomisationStrategy {
 public:
+	using RandomisationStrategy::RandomisationStrategy;
 	const RepositoryID* randomize(const RepositoryID* in_out_ID) override final;
 };
 
 //Randomizes all NPC weapons without type restrictions and replaces flash grenades with frag grenades.
 class UnrestrictedNPCRandomization : public RandomisationStrategy {
 public:
+	using RandomisationStrategy::RandomisationStrategy;
 	const RepositoryID* randomize(const RepositoryID* in_out_ID) override final;
+	bool hasRequiredItems() const override final;
 };
 
 class SleepyNPCRandomization : public RandomisationStrategy {
 public:
+	using RandomisationStrategy::RandomisationStrategy;
 	const RepositoryID* randomize(const RepositoryID* in_out_ID) override final;
+	bool hasRequiredItems() const override final;
+};
+
+//Replaces NPC weapons with items matching the Custom.NPC word lists of the config.
+class CustomNPCRandomization : public RandomisationStrategy {
+private:
+	CustomItemFilter filter;
+	const CandidateSet* candidates = nullptr;
+
+public:
+	using RandomisationStrategy::RandomisationStrategy;
+	const RepositoryID* randomize(const RepositoryID* in_out_ID) override final;
+	void initialize(Scenario scen, const DefaultItemPool* const default_pool) override final;
 };
 
+//Binds a strategy to a randomizer slot for one scene. The strategy isn't owned, in game it lives
+//in the StrategyCache and is shared with the randomizers of other scenes using the same config.
 class Randomizer {
 private:
 	bool enabled;
-	std::unique_ptr<RandomisationStrategy> strategy;
+	RandomisationStrategy* strategy;
+	std::pmr::memory_resource* scene_memory;
 
 public:
-	Randomizer(RandomisationStrategy*);
+	Randomizer(RandomisationStrategy* strategy, std::pmr::memory_resource* scene_memory);
 	const RepositoryID* randomize(const RepositoryID* id);
-	void initialize(Scenario, const DefaultItemPool* const);
+	void initialize(Scenario, const DefaultItemPool* const, bool borrowed_pool = false);
 	void disable();
 };
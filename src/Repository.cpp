@@ -1,113 +1,459 @@
 #include "Repository.h"
 #include "Config.h"
+#include "Console.h"
+#include "GuidMap.h"
+#include "Hash.h"
 #include "Item.h"
 #include "RNG.h"
 #include "RepositoryID.h"
+#include "SaxLoaders.h"
 #include <algorithm>
-#include <filesystem>
-#include <fstream>
-#include <unordered_set>
+#include <atomic>
+#include <exception>
+#include <functional>
 
-using json = nlohmann::json;
+ItemRepository::ItemRepository(const ItemRepository* previous) {
+    auto ignore_list_path = Config::retailPath("IgnoreList.json");
+    auto repository_path = Config::retailPath("Repository.json");
+    // Taken before parsing, an edit during the load is picked up by the next reload
+    ignore_list_stamp = FileStamp::of(ignore_list_path);
+    repository_stamp = FileStamp::of(repository_path);
 
-ItemRepository::ItemRepository() {
-    std::string ignorelist_file = Config::base_directory + "\\Retail\\IgnoreList.json";
-    std::ifstream ignorelist_ifs(ignorelist_file);
-
-    json ig_set;
-    ignorelist_ifs >> ig_set;
-    ignorelist_ifs.close();
+    GuidSet ignore_list;
+    IgnoreListSaxHandler ignore_list_handler(
+    [&ignore_list](const RepositoryID& id) { ignore_list.insert(id); });
+    if(!saxParseFile(ignore_list_path, ignore_list_handler)) {
+        LOG_ERROR("Failed to load IgnoreList.json: %s\n", ignore_list_handler.getError().c_str());
+        throw "ItemRepository: IgnoreList.json could not be loaded";
+    }
 
-    std::unordered_set<RepositoryID> ignore_list;
-    for(const auto& it : ig_set["GLOBAL_IGNORE_LIST"].items()) {
-        RepositoryID id(it.value());
-        ignore_list.insert(id);
+    if(previous) {
+        ids = previous->ids;
+        items = previous->items;
+        item_weights = previous->item_weights;
+        generation = previous->generation + 1;
+    } else {
+        ids = std::make_shared<RepositoryIdStore>();
     }
+    auto previous_size = items.size();
+    std::vector<bool> loaded(previous_size, false);
 
-    std::string repository_file = Config::base_directory + "\\Retail\\Repository.json";
-    std::ifstream repository_ifs(repository_file);
+    GuidSet loaded_ids;
+    RepositorySaxHandler repository_handler([&](const RepositoryID& id,
+                                                const ItemDescriptor& desc) {
+        if(ignore_list.contains(id) || !loaded_ids.insert(id))
+            return;
 
-    json repository_json;
-    repository_ifs >> repository_json;
-    repository_ifs.close();
+        Item item(desc);
+        auto handle = previous ? previous->handles.find(id) : std::nullopt;
+        if(!handle) {
+            changed_rows.push_back(static_cast<ItemHandle>(items.size()));
+            ids->set(items.size(), id);
+            items.push_back(item);
+            item_weights.push_back(desc.weight);
+            loaded.push_back(true);
+            return;
+        }
 
-    for(const auto& it : repository_json.items()) {
-        RepositoryID id(it.key());
-        if(!ignore_list.count(id)) {
-            ids.insert(id);
-            items[id] = Item(it.value());
+        if(!previous->isLive(*handle) || !(items[*handle] == item) ||
+           item_weights[*handle] != desc.weight) {
+            changed_rows.push_back(*handle);
+            items[*handle] = item;
+            item_weights[*handle] = desc.weight;
         }
+        loaded[*handle] = true;
+    });
+    if(!saxParseFile(repository_path, repository_handler)) {
+        LOG_ERROR("Failed to load Repository.json: %s\n", repository_handler.getError().c_str());
+        throw "ItemRepository: Repository.json could not be loaded";
+    }
+
+    live = ItemBitset(items.size());
+    for(ItemHandle handle = 0; handle < items.size(); ++handle) {
+        if(loaded[handle])
+            live.set(handle);
+        else if(previous && previous->isLive(handle))
+            changed_rows.push_back(handle); // removed or ignored since the last load
+    }
+
+    // Tombstoned rows stay in the hash so a re-added item gets its old handle back
+    if(previous && items.size() == previous_size) {
+        handles = previous->handles;
+    } else {
+        std::vector<RepositoryID> keys(items.size());
+        for(ItemHandle handle = 0; handle < items.size(); ++handle)
+            keys[handle] = (*ids)[handle];
+        handles = GuidPerfectHash(keys);
+    }
+
+    const auto& names = Item::names();
+    LOG_INFO("ItemRepository: %zu items (%zu changed), %zu bytes of attributes, %zu names in %zu "
+             "bytes (%zu reserved)\n",
+             live.count(), changed_rows.size(), items.size() * sizeof(Item), names.stringCount(),
+             names.usedBytes(), names.reservedBytes());
+
+    for(const auto& entry : WellKnownItems::items) {
+        auto handle = getHandle(entry.id);
+        if(!handle)
+            LOG_ERROR("Well-known item %s [%s] is missing from Repository.json or ignored\n",
+                      entry.name, entry.id.text().c_str());
+        well_known_handles[static_cast<size_t>(entry.item)] = handle;
+    }
+
+    for(ItemHandle handle = 0; handle < items.size(); ++handle) {
+        const auto& item = items[handle];
+        uint8_t attributes[] = { static_cast<uint8_t>(item.getType()),
+                                 static_cast<uint8_t>(item.getCheatGroup()),
+                                 static_cast<uint8_t>(item.getThrowType()),
+                                 static_cast<uint8_t>(item.getSilenceRating()), live.test(handle) };
+        auto name = item.string();
+        const auto& id = (*ids)[handle];
+        auto row = Hash::bytes(&id.id, sizeof(id.id));
+        row = Hash::combine64(row, Hash::bytes(attributes, sizeof(attributes)));
+        row = Hash::combine64(row, Hash::bytes(name.data(), name.size()));
+        row = Hash::combine64(row, Hash::bytes(&item_weights[handle], sizeof(double)));
+        content_hash = Hash::combine64(content_hash, row);
     }
 }
 
 const RepositoryID* ItemRepository::getStablePointer(const RepositoryID& in) const {
-    for(const auto& id : ids)
-        if(id == in)
-            return &id;
-    return nullptr;
+    auto handle = getHandle(in);
+    if(!handle)
+        return nullptr;
+    return &(*ids)[*handle];
+}
+
+const RepositoryID* ItemRepository::getStablePointer(ItemHandle handle) const {
+    return &(*ids)[handle];
+}
+
+const RepositoryID* ItemRepository::getStablePointer(WellKnownItem item) const {
+    auto handle = getHandle(item);
+    if(!handle)
+        return nullptr;
+    return &(*ids)[*handle];
 }
 
 const Item* ItemRepository::getItem(const RepositoryID& id) const {
-    if(contains(id))
-        return &items.at(id);
-    return nullptr;
+    auto handle = getHandle(id);
+    if(!handle)
+        return nullptr;
+    return &items[*handle];
+}
+
+const Item& ItemRepository::getItem(ItemHandle handle) const {
+    return items[handle];
+}
+
+std::optional<ItemHandle> ItemRepository::getHandle(const RepositoryID& id) const {
+    auto handle = handles.find(id);
+    if(!handle || !live.test(*handle))
+        return std::nullopt;
+    return handle;
+}
+
+std::optional<ItemHandle> ItemRepository::getHandle(WellKnownItem item) const {
+    return well_known_handles[static_cast<size_t>(item)];
+}
+
+double ItemRepository::getWeight(ItemHandle handle) const {
+    return item_weights[handle];
+}
+
+const std::vector<Item>& ItemRepository::getItems() const {
+    return items;
 }
 
-const std::unordered_set<RepositoryID>& ItemRepository::getIds() const {
-    return ids;
+size_t ItemRepository::size() const {
+    return items.size();
 }
 
 bool ItemRepository::contains(const RepositoryID& id) const {
-    if(items.count(id))
-        return true;
-    return false;
+    return getHandle(id).has_value();
 }
 
-RandomDrawRepository::RandomDrawRepository() : rng_engine(RNG::inst().getEngine()) {
+bool ItemRepository::isLive(ItemHandle handle) const {
+    return live.test(handle);
 }
 
-RandomDrawRepository& RandomDrawRepository::inst() {
-    static RandomDrawRepository instance;
+const ItemBitset& ItemRepository::liveRows() const {
+    return live;
+}
+
+const std::vector<ItemHandle>& ItemRepository::getChangedRows() const {
+    return changed_rows;
+}
+
+uint32_t ItemRepository::getGeneration() const {
+    return generation;
+}
+
+uint64_t ItemRepository::getContentHash() const {
+    return content_hash;
+}
+
+bool ItemRepository::filesChanged() const {
+    auto repository_path = Config::retailPath("Repository.json");
+    auto ignore_list_path = Config::retailPath("IgnoreList.json");
+    return !(FileStamp::of(repository_path) == repository_stamp) ||
+           !(FileStamp::of(ignore_list_path) == ignore_list_stamp);
+}
+
+struct RandomDrawRepository::Snapshots {
+    std::atomic<RandomDrawRepository*> current;
+    std::unique_ptr<RandomDrawRepository> owner;
+    // Replaced at the last scene load, strategies and the game may still point into these
+    std::vector<std::unique_ptr<RandomDrawRepository>> retired;
+
+    Snapshots() : owner(new RandomDrawRepository(nullptr)) {
+        current.store(owner.get(), std::memory_order_release);
+    }
+};
+
+RandomDrawRepository::RandomDrawRepository(const RandomDrawRepository* previous)
+: ItemRepository(previous), rng_engine(RNG::inst().getEngine()),
+  item_index(getItems(), liveRows(), previous ? &previous->item_index : nullptr, getChangedRows()),
+  weights(size(), 1.0), scratch_values(size()), scratch_stamps(size(), 0) {
+}
+
+RandomDrawRepository::Snapshots& RandomDrawRepository::snapshots() {
+    static Snapshots instance;
     return instance;
 }
 
-void RandomDrawRepository::getRandom(std::vector<const RepositoryID*>& item_set,
-                                     unsigned int count,
-                                     bool (Item::*fn)() const) {
-    auto hash = (void*&)fn;
-    if(!cache.count(hash)) {
-        cache[hash] = new std::vector<const RepositoryID*>();
-        for(const auto& id : getIds()) {
-            if((getItem(id)->*fn)())
-                cache[hash]->push_back(&id);
-        }
+RandomDrawRepository& RandomDrawRepository::inst() {
+    return *snapshots().current.load(std::memory_order_acquire);
+}
+
+bool RandomDrawRepository::reloadIfChanged() {
+    auto& snaps = snapshots();
+    snaps.retired.clear();
+    if(!snaps.owner->filesChanged())
+        return false;
+
+    std::unique_ptr<RandomDrawRepository> next;
+    try {
+        next.reset(new RandomDrawRepository(snaps.owner.get()));
+    } catch(const char* err) {
+        LOG_ERROR("Repository reload failed, keeping the loaded repository: %s\n", err);
+        return false;
+    } catch(const std::exception& err) {
+        LOG_ERROR("Repository reload failed, keeping the loaded repository: %s\n", err.what());
+        return false;
     }
 
-    auto dist = std::uniform_int_distribution<int>(0, cache[hash]->size() - 1);
+    snaps.current.store(next.get(), std::memory_order_release);
+    snaps.retired.push_back(std::move(snaps.owner));
+    snaps.owner = std::move(next);
+    return true;
+}
 
-    for(int i = 0; i < count; ++i)
-        item_set.push_back(cache[hash]->operator[](dist(*rng_engine)));
+ItemIndex& RandomDrawRepository::index() {
+    return item_index;
+}
+
+const RepositoryID* RandomDrawRepository::getRandom(const CandidateSet& candidates) {
+    if(candidates.empty())
+        return nullptr;
+    auto dist = std::uniform_int_distribution<size_t>(0, candidates.size() - 1);
+    return getStablePointer(candidates.handles[dist(*rng_engine)]);
+}
+
+const RepositoryID* RandomDrawRepository::getRandom(const ItemBitset& candidates) {
+    auto cnt = candidates.count();
+    if(cnt == 0)
+        return nullptr;
+    auto dist = std::uniform_int_distribution<size_t>(0, cnt - 1);
+    return getStablePointer(candidates.select(dist(*rng_engine)));
+}
+
+const RepositoryID* RandomDrawRepository::getRandom(bool (Item::*fn)() const) {
+    return getRandom(item_index.byPredicate(fn));
 }
 
 const RepositoryID* RandomDrawRepository::getRandom(std::function<bool(const Item&)> fn) {
     std::vector<const RepositoryID*> res;
     getRandom(res, 1, fn);
-    return res[0];
+    return res.empty() ? nullptr : res[0];
+}
+
+void RandomDrawRepository::getRandom(std::vector<const RepositoryID*>& item_set,
+                                     unsigned int count,
+                                     const CandidateSet& candidates) {
+    if(candidates.empty())
+        return;
+
+    auto dist = std::uniform_int_distribution<size_t>(0, candidates.size() - 1);
+    for(unsigned int i = 0; i < count; ++i)
+        item_set.push_back(getStablePointer(candidates.handles[dist(*rng_engine)]));
+}
+
+void RandomDrawRepository::getRandom(std::vector<const RepositoryID*>& item_set,
+                                     unsigned int count,
+                                     bool (Item::*fn)() const) {
+    getRandom(item_set, count, item_index.byPredicate(fn));
 }
 
-// TODO: build cacheable version of this function that takes  bool(Item::* fn)(const Item&)const instead of lambda
+// Ad hoc predicates can't be indexed, prefer the CandidateSet and ItemBitset overloads
 void RandomDrawRepository::getRandom(std::vector<const RepositoryID*>& item_set,
                                      unsigned int count,
                                      std::function<bool(const Item&)> fn) {
-    auto candidates = std::vector<const RepositoryID*>();
-    for(const auto& id : getIds()) {
-        if(fn(*getItem(id)))
-            candidates.push_back(&id);
+    getRandom(item_set, count, item_index.fromPredicate(fn));
+}
+
+size_t RandomDrawRepository::getDistinctRandom(std::span<const RepositoryID*> out,
+                                               const CandidateSet& candidates,
+                                               unsigned int max_repeats) {
+    auto n = candidates.size();
+    if(n == 0)
+        return 0;
+
+    auto limit = out.size();
+    if(max_repeats && n * max_repeats < limit)
+        limit = n * max_repeats;
+
+    auto position = [this](uint32_t i) {
+        return scratch_stamps[i] == scratch_generation ? scratch_values[i] : i;
+    };
+
+    size_t written = 0;
+    while(written < limit) {
+        if(++scratch_generation == 0) {
+            std::fill(scratch_stamps.begin(), scratch_stamps.end(), 0);
+            scratch_generation = 1;
+        }
+
+        // Partial Fisher-Yates: the first round items of the permutation are distinct
+        auto round = std::min(limit - written, n);
+        for(uint32_t i = 0; i < round; ++i) {
+            auto last = static_cast<uint32_t>(n - 1);
+            auto j = std::uniform_int_distribution<uint32_t>(i, last)(*rng_engine);
+            auto picked = position(j);
+            scratch_values[j] = position(i);
+            scratch_stamps[j] = scratch_generation;
+            out[written++] = getStablePointer(candidates.handles[picked]);
+        }
     }
+    return written;
+}
+
+void RandomDrawRepository::updateWeights() {
+    const auto& config = Config::current();
+    std::vector<double> new_weights(size());
+    for(ItemHandle handle = 0; handle < size(); ++handle) {
+        new_weights[handle] = getWeight(handle);
 
+        auto category_weight = config.categoryWeights.find(getItem(handle).getTypeName());
+        if(category_weight != config.categoryWeights.end())
+            new_weights[handle] *= category_weight->second;
+    }
+
+    for(const auto& item_weight : config.itemWeights) {
+        auto handle = getHandle(RepositoryID(item_weight.first));
+        if(handle)
+            new_weights[*handle] = item_weight.second;
+    }
+
+    if(new_weights == weights)
+        return;
+
+    weights = std::move(new_weights);
+    // Rows that aren't live are never drawn, their weight doesn't matter
+    const auto& live_items = index().all().handles;
+    auto first_weight = live_items.empty() ? 0.0 : weights[live_items[0]];
+    uniform_weights = std::all_of(live_items.begin(), live_items.end(),
+                                  [&](ItemHandle h) { return weights[h] == first_weight; });
+    alias_tables.clear();
+}
+
+bool RandomDrawRepository::hasUniformWeights() const {
+    return uniform_weights;
+}
+
+const RandomDrawRepository::WeightedCandidates&
+RandomDrawRepository::getAliasTable(const CandidateSet& candidates) {
+    auto& entry = alias_tables[candidates.bits.hash()];
+    if(!entry || !(entry->bits == candidates.bits)) {
+        std::vector<double> candidate_weights;
+        candidate_weights.reserve(candidates.size());
+        for(const auto& handle : candidates.handles)
+            candidate_weights.push_back(weights[handle]);
+
+        entry = std::make_unique<WeightedCandidates>(
+        WeightedCandidates{ candidates.bits, candidates.handles, AliasTable(candidate_weights) });
+    }
+    return *entry;
+}
+
+const RepositoryID* RandomDrawRepository::getWeightedRandom(const CandidateSet& candidates) {
+    if(uniform_weights || candidates.empty())
+        return getRandom(candidates);
+
+    const auto& weighted = getAliasTable(candidates);
+    if(weighted.table.empty())
+        return nullptr;
+    return getStablePointer(weighted.handles[weighted.table.sample(*rng_engine)]);
+}
+
+size_t RandomDrawRepository::getWeightedRandom(std::span<const RepositoryID*> out,
+                                               const CandidateSet& candidates,
+                                               unsigned int max_repeats) {
+    if(candidates.empty())
+        return 0;
+
+    auto n = candidates.size();
+    const WeightedCandidates* weighted = nullptr;
+    if(!uniform_weights) {
+        weighted = &getAliasTable(candidates);
+        if(weighted->table.empty())
+            return 0;
+    }
+    auto sample = [&]() -> uint32_t {
+        if(weighted)
+            return static_cast<uint32_t>(weighted->table.sample(*rng_engine));
+        return std::uniform_int_distribution<uint32_t>(0, static_cast<uint32_t>(n - 1))(
+        *rng_engine);
+    };
+    // Candidate i of the set is also row i of its alias table
+    const auto& handles = weighted ? weighted->handles : candidates.handles;
+
+    if(max_repeats == 0) {
+        for(auto& slot : out)
+            slot = getStablePointer(handles[sample()]);
+        return out.size();
+    }
+
+    if(++scratch_generation == 0) {
+        std::fill(scratch_stamps.begin(), scratch_stamps.end(), 0);
+        scratch_generation = 1;
+    }
+    size_t written = 0;
+    for(unsigned int rejections = 0; written < out.size() && rejections < max_rejections;) {
+        auto i = sample();
+        if(scratch_stamps[i] != scratch_generation) {
+            scratch_stamps[i] = scratch_generation;
+            scratch_values[i] = 0;
+        }
+        if(scratch_values[i] == max_repeats) {
+            ++rejections;
+            continue;
+        }
+        ++scratch_values[i];
+        rejections = 0;
+        out[written++] = getStablePointer(handles[i]);
+    }
+    return written;
+}
 
-    auto dist = std::uniform_int_distribution<int>(0, candidates.size() - 1);
+void RandomDrawRepository::getWeightedRandom(std::vector<const RepositoryID*>& item_set,
+                                             unsigned int count,
+                                             const CandidateSet& candidates) {
+    if(uniform_weights || candidates.empty())
+        return getRandom(item_set, count, candidates);
 
-    for(int i = 0; i < count; ++i)
-        item_set.push_back(candidates[dist(*rng_engine)]);
+    const auto& weighted = getAliasTable(candidates);
+    if(weighted.table.empty())
+        return;
+    for(unsigned int i = 0; i < count; ++i)
+        item_set.push_back(getStablePointer(weighted.handles[weighted.table.sample(*rng_engine)]));
 }
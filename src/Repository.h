@@ -1,11 +1,23 @@
 #pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <random>
+#include <span>
 #include <unordered_map>
 #include <unordered_set>
-#include "..\thirdparty\json.hpp"
+#include "../thirdparty/json.hpp"
 #include "Scenario.h"
+#include "AliasTable.h"
+#include "FileStamp.h"
+#include "GuidPerfectHash.h"
 #include "Item.h"
+#include "ItemBitset.h"
+#include "ItemIndex.h"
 #include "RepositoryID.h"
+#include "RepositoryIdStore.h"
+#include "WellKnownItems.h"
 
 
 using json = nlohmann::json;
@@ -14,39 +26,150 @@ using json = nlohmann::json;
 class ItemRepository
 {
 private:
-	std::unordered_set<RepositoryID> ids;
-	std::unordered_map<RepositoryID, Item> items;
+	//Shared with the snapshots this one was derived from and those derived from it, pointers
+	//returned by getStablePointer stay valid for the life of the process
+	std::shared_ptr<RepositoryIdStore> ids;
+	std::vector<Item> items;
+	GuidPerfectHash handles;
+	std::vector<double> item_weights;
+	std::array<std::optional<ItemHandle>, static_cast<size_t>(WellKnownItem::COUNT)>
+		well_known_handles;
+
+	//Rows of items that were removed or ignored since the first load keep their handle, so
+	//handles stay valid across reloads, but they aren't live and can't be looked up or drawn.
+	ItemBitset live;
+	//Rows that differ from the snapshot this repository was derived from
+	std::vector<ItemHandle> changed_rows;
+	FileStamp repository_stamp;
+	FileStamp ignore_list_stamp;
+	uint32_t generation = 0;
+	uint64_t content_hash = 0;
+
+protected:
+	//Loads Repository.json and IgnoreList.json. Starting from previous (if any), unchanged rows are
+	//copied as they are, changed rows are rewritten in place and new items are appended.
+	explicit ItemRepository(const ItemRepository* previous);
+
+	const std::vector<ItemHandle>& getChangedRows() const;
 
 public:
-	ItemRepository();
 
 	//Returns a pointer into the repository entry that matches the input ID.
 	//This function is intended to be used to convert a const reference to a RpoID into and id that can be passed to the game.
 	const RepositoryID* getStablePointer(const RepositoryID&) const;
+	const RepositoryID* getStablePointer(ItemHandle) const;
+	//nullptr if the well-known item is missing from the repository
+	const RepositoryID* getStablePointer(WellKnownItem) const;
 	const Item* getItem(const RepositoryID&) const;
-	const std::unordered_set<RepositoryID>& getIds() const;
+	const Item& getItem(ItemHandle) const;
+	//Single lookup for hot paths: returns the handle of the item, or nothing if the ID isn't in
+	//the repository.
+	std::optional<ItemHandle> getHandle(const RepositoryID&) const;
+	//Well-known items are resolved on load. One that is missing from Repository.json or hidden by
+	//IgnoreList.json is logged and has no handle, strategies that need it aren't used then.
+	std::optional<ItemHandle> getHandle(WellKnownItem) const;
+	//Draw weight of the item as defined in Repository.json
+	double getWeight(ItemHandle) const;
+	const std::vector<Item>& getItems() const;
+	//Number of rows, including rows that aren't live
+	size_t size() const;
 	bool contains(const RepositoryID&) const;
+	bool isLive(ItemHandle) const;
+	const ItemBitset& liveRows() const;
+	//Incremented with every reload, lets caches built from an earlier snapshot notice the change
+	uint32_t getGeneration() const;
+	//True if Repository.json or IgnoreList.json changed on disk since this snapshot was loaded
+	bool filesChanged() const;
+	//Hash of every row in handle order: id, attributes, name, weight and whether it is live. Equal
+	//hashes mean draws from the repository give equal results for equal random numbers.
+	uint64_t getContentHash() const;
 };
 
 //Provides random access functionality to the ItemRepository
 class RandomDrawRepository : public ItemRepository
 {
 private:
+	struct WeightedCandidates {
+		ItemBitset bits;
+		std::vector<ItemHandle> handles;
+		AliasTable table;
+	};
+
+	struct Snapshots;
+
 	std::mt19937* rng_engine;
+	ItemIndex item_index;
+
+	//Effective draw weights, uniform unless configured otherwise
+	std::vector<double> weights;
+	bool uniform_weights = true;
+	std::unordered_map<uint64_t, std::unique_ptr<WeightedCandidates>> alias_tables;
+
+	//Sparse Fisher-Yates scratch space: position i holds scratch_values[i] if its stamp matches the
+	//current generation and i otherwise, so every draw round starts from the identity permutation
+	//without an O(n) reset. Capped weighted draws keep their per candidate counts in it the same way.
+	std::vector<uint32_t> scratch_values;
+	std::vector<uint32_t> scratch_stamps;
+	uint32_t scratch_generation = 0;
 
-	//TODO: fix memory
-	std::unordered_map<void*, std::vector<const RepositoryID *>*> cache;
+	explicit RandomDrawRepository(const RandomDrawRepository* previous);
 
-	RandomDrawRepository();
+	static Snapshots& snapshots();
+	const WeightedCandidates& getAliasTable(const CandidateSet& candidates);
 
 public:
+	RandomDrawRepository(const RandomDrawRepository&) = delete;
+	RandomDrawRepository& operator=(const RandomDrawRepository&) = delete;
+
+	//Returns the current snapshot of the repository. The items of a snapshot are never modified
+	//after it has been published, reloads publish a new one instead.
 	//TODO:Doesn't have to be a singleton, use dependency injection
 	static RandomDrawRepository& inst();
 
-	//get random RepositoryID that satisfy the test function fn;
-	//RepositoryID getRandom(bool(Item::* fn)()const) const;
+	//Called on scene load. If Repository.json or IgnoreList.json changed, builds a new snapshot
+	//from the current one and publishes it with an atomic pointer swap; code still running on the
+	//old snapshot is unaffected. Replaced snapshots are kept alive until the next scene load since
+	//the randomizers of the previous scene may still use them. Ids live in a store shared by all
+	//snapshots, so ids handed to the game outlive any snapshot. Returns true if a new snapshot
+	//was published.
+	static bool reloadIfChanged();
+
+	ItemIndex& index();
+
+	//Draws a single item from a precomputed candidate set, returns nullptr if the set is empty.
+	const RepositoryID* getRandom(const CandidateSet& candidates);
+	//Draws a single item from an ad hoc combination of candidate bitsets.
+	const RepositoryID* getRandom(const ItemBitset& candidates);
+	const RepositoryID* getRandom(bool(Item::* fn)()const);
 	const RepositoryID* getRandom(std::function<bool(const Item& it)>);
+	void getRandom(std::vector<const RepositoryID*>& item_set, unsigned int count,
+		const CandidateSet& candidates);
 	void getRandom(std::vector<const RepositoryID*>& item_set, unsigned int count, bool(Item::* fn)()const);
 	void getRandom(std::vector<const RepositoryID*>& item_set, unsigned int count, std::function<bool(const Item& it)>);
 
+	//Fills out with items drawn without replacement. Once every candidate has been drawn the
+	//candidates are drawn again, but no item appears more than max_repeats times (0 = no limit).
+	//Returns the number of items written, which is less than out.size() if the limit was hit.
+	size_t getDistinctRandom(std::span<const RepositoryID*> out, const CandidateSet& candidates,
+		unsigned int max_repeats = 0);
+
+	//Recomputes the effective draw weights from the repository and the config. Cached alias
+	//tables are only dropped if the weights actually changed.
+	void updateWeights();
+	bool hasUniformWeights() const;
+
+	//Weighted draws. Alias tables are built once per candidate set and weight vector. Nothing is
+	//drawn (nullptr, or no items appended) if the set is empty or all of its weights are 0, the
+	//caller keeps the original item then.
+	const RepositoryID* getWeightedRandom(const CandidateSet& candidates);
+	void getWeightedRandom(std::vector<const RepositoryID*>& item_set, unsigned int count,
+		const CandidateSet& candidates);
+	//Fills out with weighted draws in which no item appears more than max_repeats times (0 = no
+	//limit). A draw of an item at the limit is rejected and drawn again. After max_rejections
+	//rejections in a row the remaining items carry too little weight to be reached, drawing stops.
+	//Returns the number of items written.
+	size_t getWeightedRandom(std::span<const RepositoryID*> out, const CandidateSet& candidates,
+		unsigned int max_repeats);
+	static constexpr unsigned int max_rejections = 64;
+
 };
\ No newline at end of file
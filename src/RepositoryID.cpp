@@ -1,24 +1,41 @@
 #include "RepositoryID.h"
 
-RepositoryID::RepositoryID(const RepositoryID& guid) {
-	id = guid.id;
+RepositoryID::RepositoryID(std::string_view id_string) : id{} {
+	if(id_string.size() == GuidText::length)
+		GuidText::decode(id_string.data(), id);
 }
 
-RepositoryID::RepositoryID(const std::string& id_string) {
-	UuidFromStringA((unsigned char*)id_string.c_str(), &id);
-};
+std::optional<RepositoryID> RepositoryID::parse(std::string_view id_string) {
+	auto guid = GuidText::parse(id_string);
+	if(!guid)
+		return std::nullopt;
+	return RepositoryID(*guid);
+}
 
-RepositoryID& RepositoryID::operator=(const RepositoryID& guid) {
-	id = guid.id;
-	return *this;
+size_t RepositoryID::parseMany(std::string_view packed, RepositoryID* out) {
+	size_t count = packed.size() / GuidText::length;
+	for(size_t i = 0; i < count; ++i)
+		if(!GuidText::decode(packed.data() + i * GuidText::length, out[i].id))
+			return i;
+	return count;
 }
 
 bool RepositoryID::operator ==(const RepositoryID& guid) const {
 	return id == guid.id;
 }
 
+char* RepositoryID::format(char* out) const {
+	return GuidText::format(id, out);
+}
+
+RepositoryID::Text RepositoryID::text() const {
+	Text text;
+	*format(text.chars) = '\0';
+	return text;
+}
+
 std::string RepositoryID::toString() const {
-	unsigned char* guid_str;
-	UuidToStringA(&id, &guid_str);
-	return std::string((char*)guid_str);
-}
\ No newline at end of file
+	char text[GuidText::length];
+	format(text);
+	return std::string(text, GuidText::length);
+}
@@ -1,21 +1,80 @@
 #pragma once
-#include <rpc.h>
+#include <optional>
 #include <string>
-
-#pragma comment(lib, "Rpcrt4.lib")
+#include <string_view>
+#if __has_include(<format>)
+#include <format>
+#endif
+#include "Guid.h"
 
 struct RepositoryID {
-	GUID id;
+	Guid id;
+
+	constexpr RepositoryID() : id{} {}
+	constexpr explicit RepositoryID(const Guid& guid) : id(guid) {}
+	constexpr RepositoryID(const RepositoryID& guid) = default;
+	//Invalid strings give the nil id, use parse() to detect them
+	RepositoryID(std::string_view id_string);
+
+	//Parses the 36 character form xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx (hex digits in either case)
+	static std::optional<RepositoryID> parse(std::string_view id_string);
+	//Parses ids stored back to back in packed, 36 characters each. Returns the number of ids
+	//written to out, parsing stops at the first invalid id.
+	static size_t parseMany(std::string_view packed, RepositoryID* out);
+
+	//Null terminated text form that lives on the stack, for logging: id.text().c_str()
+	struct Text {
+		char chars[37];
 
-	RepositoryID(const RepositoryID& guid);
-	RepositoryID(const std::string& id_string);
+		const char* c_str() const { return chars; }
+		std::string_view view() const { return std::string_view(chars, 36); }
+	};
 
+	//Writes the 36 character lowercase text form to out (not null terminated) and returns the
+	//end of the written range
+	char* format(char* out) const;
+	Text text() const;
 	std::string toString() const;
 
-	RepositoryID& operator=(const RepositoryID& guid);
+	constexpr RepositoryID& operator=(const RepositoryID& guid) = default;
 	bool operator==(const RepositoryID& guid) const;
 };
 
+namespace GuidLiterals {
+	consteval unsigned int hexValue(char c) {
+		if(c >= '0' && c <= '9')
+			return c - '0';
+		if(c >= 'a' && c <= 'f')
+			return c - 'a' + 10;
+		if(c >= 'A' && c <= 'F')
+			return c - 'A' + 10;
+		throw "RepositoryID literal: invalid hex digit";
+	}
+
+	consteval unsigned int hexRange(const char* text, size_t begin, size_t end) {
+		unsigned int value = 0;
+		for(size_t i = begin; i < end; ++i)
+			value = value << 4 | hexValue(text[i]);
+		return value;
+	}
+
+	//"01ed6d15-e26e-4362-b1a6-363684a7d0fd"_guid, malformed literals don't compile
+	consteval RepositoryID operator""_guid(const char* text, size_t length) {
+		if(length != 36 || text[8] != '-' || text[13] != '-' || text[18] != '-' || text[23] != '-')
+			throw "RepositoryID literal: expected xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx";
+
+		Guid guid{};
+		guid.Data1 = hexRange(text, 0, 8);
+		guid.Data2 = static_cast<uint16_t>(hexRange(text, 9, 13));
+		guid.Data3 = static_cast<uint16_t>(hexRange(text, 14, 18));
+		guid.Data4[0] = static_cast<uint8_t>(hexRange(text, 19, 21));
+		guid.Data4[1] = static_cast<uint8_t>(hexRange(text, 21, 23));
+		for(size_t i = 0; i < 6; ++i)
+			guid.Data4[2 + i] = static_cast<uint8_t>(hexRange(text, 24 + 2 * i, 26 + 2 * i));
+		return RepositoryID(guid);
+	}
+}
+
 template<>
 struct std::hash<RepositoryID> {
 	size_t operator()(const RepositoryID& guid) const {
@@ -26,4 +85,15 @@ struct std::hash<RepositoryID> {
 		}
 		return hash;
 	}
-};
\ No newline at end of file
+};
+
+#ifdef __cpp_lib_format
+//std::format("{}", id) writes the text form without going through a std::string
+template<>
+struct std::formatter<RepositoryID> : std::formatter<std::string_view> {
+	template<typename FormatContext>
+	auto format(const RepositoryID& guid, FormatContext& ctx) const {
+		return std::formatter<std::string_view>::format(guid.text().view(), ctx);
+	}
+};
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <memory>
+#include "RepositoryID.h"
+
+// Ids of all repository rows, shared by every repository snapshot. Pointers to the ids are handed
+// to the game and held in item plans, so ids never move or get freed: they are stored in fixed
+// size chunks that live as long as the store. Rows are only ever written by the thread loading a
+// new snapshot, and only rows past those of every published snapshot, so readers of a published
+// snapshot never see a write.
+class RepositoryIdStore {
+public:
+    static constexpr size_t chunk_size = 4096;
+    static constexpr size_t max_chunks = 256;
+
+    const RepositoryID& operator[](size_t row) const {
+        return chunks[row / chunk_size][row % chunk_size];
+    }
+
+    // Writes the id of a new row. Throws once the store is full.
+    void set(size_t row, const RepositoryID& id) {
+        auto chunk = row / chunk_size;
+        if(chunk >= max_chunks)
+            throw "RepositoryIdStore: too many repository rows";
+        if(!chunks[chunk])
+            chunks[chunk] = std::make_unique<RepositoryID[]>(chunk_size);
+        chunks[chunk][row % chunk_size] = id;
+    }
+
+private:
+    std::array<std::unique_ptr<RepositoryID[]>, max_chunks> chunks;
+};
@@ -1,8 +1,19 @@
 #include "SSceneInitParameters.h"
+#include "Scenario.h"
+#include "Console.h"
+
+SceneComposition SceneComposition::from(const SSceneInitParameters& sip) {
+	SceneComposition composition{ sip.m_SceneResource.view(), {} };
+	composition.bricks.reserve(sip.m_aAdditionalBrickResources.size());
+	for (size_t i = 0; i < sip.m_aAdditionalBrickResources.size(); ++i)
+		composition.bricks.push_back(sip.m_aAdditionalBrickResources[static_cast<int>(i)].view());
+	return composition;
+}
 
 void SSceneInitParameters::print() const {
-	printf("\nSSceneInitParameter hash: 0x%I64X\n", std::hash<SSceneInitParameters>()(*this));
-	printf("\t%s\n", m_SceneResource.to_string().c_str());
+	auto keys = ScenarioKeys::from(SceneComposition::from(*this));
+	LOG_INFO("\nSSceneInitParameter hash: 0x%I64X (legacy 0x%I64X)\n", keys.stable, keys.legacy);
+	LOG_INFO("\t%s\n", m_SceneResource.view());
 	for (int i = 0; i < m_aAdditionalBrickResources.size(); ++i)
-		printf("\t\t%s\n", m_aAdditionalBrickResources[i].to_string().c_str());
+		LOG_INFO("\t\t%s\n", m_aAdditionalBrickResources[i].view());
 }
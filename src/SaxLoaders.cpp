@@ -0,0 +1,229 @@
+#include "SaxLoaders.h"
+#include "MappedFile.h"
+
+bool SaxHandler::null() {
+    return true;
+}
+
+bool SaxHandler::boolean(bool) {
+    return true;
+}
+
+bool SaxHandler::number_integer(number_integer_t) {
+    return true;
+}
+
+bool SaxHandler::number_unsigned(number_unsigned_t) {
+    return true;
+}
+
+bool SaxHandler::number_float(number_float_t, const string_t&) {
+    return true;
+}
+
+bool SaxHandler::string(string_t&) {
+    return true;
+}
+
+bool SaxHandler::start_object(std::size_t) {
+    ++depth;
+    return true;
+}
+
+bool SaxHandler::key(string_t&) {
+    return true;
+}
+
+bool SaxHandler::end_object() {
+    --depth;
+    return true;
+}
+
+bool SaxHandler::start_array(std::size_t) {
+    ++depth;
+    return true;
+}
+
+bool SaxHandler::end_array() {
+    --depth;
+    return true;
+}
+
+bool SaxHandler::parse_error(std::size_t,
+                             const std::string&,
+                             const nlohmann::detail::exception& ex) {
+    error = ex.what();
+    return false;
+}
+
+const std::string& SaxHandler::getError() const {
+    return error;
+}
+
+RepositorySaxHandler::RepositorySaxHandler(EntryCallback on_entry) : on_entry(std::move(on_entry)) {
+}
+
+bool RepositorySaxHandler::onFieldValue(std::string* val) {
+    // Values nested deeper than the item object itself are of no interest
+    if(depth != 2 || current_field == Field::OTHER)
+        return true;
+
+    // Every attribute but the weight is a string, anything else is treated like a missing key
+    if(val == nullptr || current_field == Field::WEIGHT)
+        throw "RepositorySaxHandler: Some key is missing from repository entry";
+
+    switch(current_field) {
+    case Field::ICON:
+        current_item.icon = std::move(*val);
+        break;
+    case Field::CHEAT_GROUP:
+        current_item.cheat_group = std::move(*val);
+        break;
+    case Field::COMMON_NAME:
+        current_item.common_name = std::move(*val);
+        break;
+    case Field::THROW_TYPE:
+        current_item.throw_type = std::move(*val);
+        break;
+    case Field::SILENCE_RATING:
+        current_item.silence_rating = std::move(*val);
+        break;
+    default:
+        break;
+    }
+    seen_fields |= 1u << static_cast<unsigned int>(current_field);
+    return true;
+}
+
+bool RepositorySaxHandler::onNumericFieldValue(double val) {
+    if(depth != 2 || current_field != Field::WEIGHT)
+        return onFieldValue(nullptr);
+
+    if(val < 0.0)
+        throw "RepositorySaxHandler: Negative item weight in repository entry";
+    current_item.weight = val;
+    return true;
+}
+
+bool RepositorySaxHandler::number_integer(number_integer_t val) {
+    return onNumericFieldValue(static_cast<double>(val));
+}
+
+bool RepositorySaxHandler::number_unsigned(number_unsigned_t val) {
+    return onNumericFieldValue(static_cast<double>(val));
+}
+
+bool RepositorySaxHandler::number_float(number_float_t val, const string_t&) {
+    return onNumericFieldValue(val);
+}
+
+bool RepositorySaxHandler::boolean(bool) {
+    return onFieldValue(nullptr);
+}
+
+bool RepositorySaxHandler::string(string_t& val) {
+    return onFieldValue(&val);
+}
+
+bool RepositorySaxHandler::key(string_t& val) {
+    if(depth == 1) {
+        current_id = std::move(val);
+        current_item = ItemDescriptor();
+        seen_fields = 0;
+    } else if(depth == 2) {
+        if(val == "InventoryCategoryIcon")
+            current_field = Field::ICON;
+        else if(val == "CheatGroup")
+            current_field = Field::CHEAT_GROUP;
+        else if(val == "CommonName")
+            current_field = Field::COMMON_NAME;
+        else if(val == "ThrowType")
+            current_field = Field::THROW_TYPE;
+        else if(val == "SilenceRating")
+            current_field = Field::SILENCE_RATING;
+        else if(val == "Weight")
+            current_field = Field::WEIGHT;
+        else
+            current_field = Field::OTHER;
+    }
+    return true;
+}
+
+bool RepositorySaxHandler::end_object() {
+    if(depth == 2) {
+        // SilenceRating is optional, all other attributes are required
+        constexpr unsigned int required = (1u << static_cast<unsigned int>(Field::ICON)) |
+                                          (1u << static_cast<unsigned int>(Field::CHEAT_GROUP)) |
+                                          (1u << static_cast<unsigned int>(Field::COMMON_NAME)) |
+                                          (1u << static_cast<unsigned int>(Field::THROW_TYPE));
+        if((seen_fields & required) != required)
+            throw "RepositorySaxHandler: Some key is missing from repository entry";
+
+        auto id = RepositoryID::parse(current_id);
+        if(!id)
+            throw "RepositorySaxHandler: Invalid repository id";
+        on_entry(*id, current_item);
+        current_field = Field::OTHER;
+    }
+    return SaxHandler::end_object();
+}
+
+IgnoreListSaxHandler::IgnoreListSaxHandler(std::function<void(const RepositoryID&)> on_id)
+: on_id(std::move(on_id)) {
+}
+
+bool IgnoreListSaxHandler::string(string_t& val) {
+    if(depth == 2 && in_ignore_list) {
+        auto id = RepositoryID::parse(val);
+        if(!id)
+            throw "IgnoreListSaxHandler: Invalid repository id";
+        on_id(*id);
+    }
+    return true;
+}
+
+bool IgnoreListSaxHandler::key(string_t& val) {
+    if(depth == 1)
+        in_ignore_list = val == "GLOBAL_IGNORE_LIST";
+    return true;
+}
+
+DefaultItemPoolsSaxHandler::DefaultItemPoolsSaxHandler(PoolCallback on_pool)
+: on_pool(std::move(on_pool)) {
+}
+
+bool DefaultItemPoolsSaxHandler::string(string_t& val) {
+    // Ids are collected as text and decoded in one pass when the pool ends
+    if(depth == 2) {
+        if(val.size() != guid_text_length)
+            throw "DefaultItemPoolsSaxHandler: Invalid repository id";
+        current_text += val;
+    }
+    return true;
+}
+
+bool DefaultItemPoolsSaxHandler::key(string_t& val) {
+    if(depth == 1) {
+        current_scenario = std::stoull(val, nullptr, 0x10);
+        current_text.clear();
+    }
+    return true;
+}
+
+bool DefaultItemPoolsSaxHandler::end_array() {
+    if(depth == 2) {
+        std::vector<RepositoryID> ids(current_text.size() / guid_text_length);
+        if(RepositoryID::parseMany(current_text, ids.data()) != ids.size())
+            throw "DefaultItemPoolsSaxHandler: Invalid repository id";
+        on_pool(current_scenario, std::move(ids));
+    }
+    return SaxHandler::end_array();
+}
+
+bool saxParseFile(const std::string& path, SaxHandler& handler) {
+    MappedFile file(path);
+    if(!file.isOpen())
+        return false;
+
+    return json::sax_parse(file.data(), file.data() + file.size(), &handler);
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+#include "../thirdparty/json.hpp"
+#include "Item.h"
+#include "RepositoryID.h"
+#include "Scenario.h"
+
+using json = nlohmann::json;
+
+// SAX handler that accepts any document without building a DOM. Loaders override the events
+// they are interested in; nesting depth is tracked here so they can tell where they are.
+class SaxHandler : public nlohmann::json_sax<json> {
+public:
+    bool null() override;
+    bool boolean(bool val) override;
+    bool number_integer(number_integer_t val) override;
+    bool number_unsigned(number_unsigned_t val) override;
+    bool number_float(number_float_t val, const string_t& s) override;
+    bool string(string_t& val) override;
+    bool start_object(std::size_t elements) override;
+    bool key(string_t& val) override;
+    bool end_object() override;
+    bool start_array(std::size_t elements) override;
+    bool end_array() override;
+    bool parse_error(std::size_t position,
+                     const std::string& last_token,
+                     const nlohmann::detail::exception& ex) override;
+
+    const std::string& getError() const;
+
+protected:
+    int depth = 0;
+    std::string error;
+};
+
+// Builds items straight from Repository.json: { "<guid>": { "CommonName": "...", ... }, ... }
+class RepositorySaxHandler : public SaxHandler {
+public:
+    using EntryCallback = std::function<void(const RepositoryID&, const ItemDescriptor&)>;
+
+    explicit RepositorySaxHandler(EntryCallback on_entry);
+
+    bool number_integer(number_integer_t val) override;
+    bool number_unsigned(number_unsigned_t val) override;
+    bool number_float(number_float_t val, const string_t& s) override;
+    bool boolean(bool val) override;
+    bool string(string_t& val) override;
+    bool key(string_t& val) override;
+    bool end_object() override;
+
+private:
+    enum class Field { ICON, CHEAT_GROUP, COMMON_NAME, THROW_TYPE, SILENCE_RATING, WEIGHT, OTHER };
+
+    EntryCallback on_entry;
+    std::string current_id;
+    Field current_field = Field::OTHER;
+    ItemDescriptor current_item;
+    unsigned int seen_fields = 0;
+
+    bool onFieldValue(std::string* val);
+    bool onNumericFieldValue(double val);
+};
+
+// Collects the GLOBAL_IGNORE_LIST array of IgnoreList.json.
+class IgnoreListSaxHandler : public SaxHandler {
+public:
+    explicit IgnoreListSaxHandler(std::function<void(const RepositoryID&)> on_id);
+
+    bool string(string_t& val) override;
+    bool key(string_t& val) override;
+
+private:
+    std::function<void(const RepositoryID&)> on_id;
+    bool in_ignore_list = false;
+};
+
+// Builds default pools from DefaultItemPools.json: { "<scenario hex>": [ "<guid>", ... ], ... }
+class DefaultItemPoolsSaxHandler : public SaxHandler {
+public:
+    using PoolCallback = std::function<void(Scenario, std::vector<RepositoryID>&&)>;
+
+    explicit DefaultItemPoolsSaxHandler(PoolCallback on_pool);
+
+    bool string(string_t& val) override;
+    bool key(string_t& val) override;
+    bool end_array() override;
+
+private:
+    PoolCallback on_pool;
+    static constexpr size_t guid_text_length = 36;
+
+    Scenario current_scenario = 0;
+    std::string current_text;
+};
+
+// Maps the file at path into memory and feeds it to the handler. Returns false if the file
+// can't be opened or isn't valid JSON, parse errors are available through handler.getError().
+bool saxParseFile(const std::string& path, SaxHandler& handler);
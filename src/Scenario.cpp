@@ -0,0 +1,50 @@
+#include "Scenario.h"
+#include "Hash.h"
+
+namespace {
+
+uint64_t fnv1a(std::string_view s) {
+    uint64_t hash = 0xcbf29ce484222325;
+    for(auto c : s) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+} // namespace
+
+bool ScenarioHash::isSimulationQualityBrick(std::string_view brick) {
+    // Digits have no case, the letters are compared with their lowercase bit set
+    for(size_t i = 0; i + 5 <= brick.size(); ++i) {
+        if(brick[i] != '6' && brick[i] != '8')
+            continue;
+        if((brick[i + 1] | 0x20) == 'c' && (brick[i + 2] | 0x20) == 'o' &&
+           (brick[i + 3] | 0x20) == 'r' && (brick[i + 4] | 0x20) == 'e')
+            return true;
+    }
+    return false;
+}
+
+Scenario ScenarioHash::stable(std::string_view scene, std::span<const std::string_view> bricks) {
+    auto hash = Hash::combine64(Hash::mix64(version), Hash::bytes(scene.data(), scene.size()));
+    for(auto brick : bricks) {
+        if(!isSimulationQualityBrick(brick))
+            hash = Hash::combine64(hash, Hash::bytes(brick.data(), brick.size()));
+    }
+    return hash;
+}
+
+Scenario ScenarioHash::legacy(std::string_view scene, std::span<const std::string_view> bricks) {
+    auto hash = fnv1a(scene);
+    for(auto brick : bricks) {
+        if(!isSimulationQualityBrick(brick))
+            hash = (hash << 1) ^ fnv1a(brick);
+    }
+    return hash;
+}
+
+ScenarioKeys ScenarioKeys::from(const SceneComposition& composition) {
+    return ScenarioKeys{ ScenarioHash::stable(composition.scene, composition.bricks),
+                         ScenarioHash::legacy(composition.scene, composition.bricks) };
+}
@@ -1,4 +1,47 @@
 #pragma once
-#include "SSceneInitParameters.h"
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
 
-using Scenario = uint64_t;
\ No newline at end of file
+struct SSceneInitParameters;
+
+using Scenario = uint64_t;
+
+// Scenario keys are the keys of DefaultItemPools.json, both hashes are specified here so that
+// offline tools can reproduce them bit for bit. Simulation quality bricks (names containing
+// "6core" or "8core" in any case) differ between machines and are skipped by both.
+//
+// stable (version 1), over the bytes of the scene resource and each remaining brick in order:
+//   h = mix64(1), then h = combine64(h, Hash::bytes(s)) for every string s
+//   (mix64, combine64 and bytes with seed 0 as defined in Hash.h)
+// legacy, the key of pool files written before the stable hash. It is what MSVC's
+// std::hash<std::string> gave on x64:
+//   h = fnv1a(scene), then h = (h << 1) ^ fnv1a(brick) for every brick
+//   (64-bit FNV-1a, offset basis 0xcbf29ce484222325, prime 0x100000001b3)
+namespace ScenarioHash {
+
+constexpr uint64_t version = 1;
+
+bool isSimulationQualityBrick(std::string_view brick);
+
+Scenario stable(std::string_view scene, std::span<const std::string_view> bricks);
+Scenario legacy(std::string_view scene, std::span<const std::string_view> bricks);
+
+} // namespace ScenarioHash
+
+// Scene resource and additional bricks of a scene load, viewing the game's strings
+struct SceneComposition {
+    std::string_view scene;
+    std::vector<std::string_view> bricks;
+
+    // Defined in SSceneInitParameters.cpp, the game types only build as part of the DLL
+    static SceneComposition from(const SSceneInitParameters& sip);
+};
+
+struct ScenarioKeys {
+    Scenario stable;
+    Scenario legacy;
+
+    static ScenarioKeys from(const SceneComposition& composition);
+};
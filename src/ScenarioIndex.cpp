@@ -0,0 +1,151 @@
+#include "ScenarioIndex.h"
+#include "Console.h"
+#include "MappedFile.h"
+#include "../thirdparty/json.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+using json = nlohmann::json;
+
+ScenarioIndex::ScenarioIndex(std::string path_) : path(std::move(path_)) {
+    MappedFile file(path);
+    if(!file.isOpen())
+        return;
+
+    auto doc = json::parse(file.view(), nullptr, false);
+    if(!doc.is_object()) {
+        LOG_ERROR("ScenarioIndex: %s is not valid, starting empty\n", path.c_str());
+        return;
+    }
+    for(const auto& [key_text, value] : doc.items()) {
+        if(!value.is_object())
+            continue;
+        auto names_json = value.find("composition");
+        auto legacy_json = value.find("legacy");
+        if(names_json == value.end() || !names_json->is_array() || names_json->empty() ||
+           legacy_json == value.end() || !legacy_json->is_string())
+            continue;
+        ScenarioKeys keys;
+        try {
+            keys.stable = std::stoull(key_text, nullptr, 0x10);
+            keys.legacy = std::stoull(legacy_json->get<std::string>(), nullptr, 0x10);
+        } catch(const std::exception&) {
+            continue;
+        }
+        std::vector<std::string> strings;
+        for(const auto& name : *names_json)
+            if(name.is_string())
+                strings.push_back(name.get<std::string>());
+        if(strings.empty())
+            continue;
+        std::vector<std::string_view> bricks(strings.begin() + 1, strings.end());
+        insert(keys, strings.front(), bricks);
+    }
+}
+
+uint32_t ScenarioIndex::intern(std::string_view name) {
+    auto id = static_cast<uint32_t>(names.size());
+    auto [it, inserted] = name_ids.try_emplace(std::string(name), id);
+    if(inserted)
+        names.push_back(it->first);
+    return it->second;
+}
+
+std::optional<uint32_t> ScenarioIndex::find(std::string_view name) const {
+    auto it = name_ids.find(std::string(name));
+    if(it == name_ids.end())
+        return std::nullopt;
+    return it->second;
+}
+
+void ScenarioIndex::insert(const ScenarioKeys& keys, std::string_view scene,
+                           const std::vector<std::string_view>& bricks) {
+    if(entry_of_key.contains(keys.stable))
+        return;
+
+    Entry entry{ keys, intern(scene), ItemBitset(), 0 };
+    std::vector<uint32_t> ids;
+    for(auto brick : bricks) {
+        if(!ScenarioHash::isSimulationQualityBrick(brick))
+            ids.push_back(intern(brick));
+    }
+    entry.bricks.resize(names.size());
+    for(auto id : ids)
+        entry.bricks.set(id);
+    entry.brick_count = static_cast<uint32_t>(entry.bricks.count());
+
+    entry_of_key[keys.stable] = entries.size();
+    entries.push_back(std::move(entry));
+}
+
+void ScenarioIndex::add(const ScenarioKeys& keys, const SceneComposition& composition) {
+    if(entry_of_key.contains(keys.stable))
+        return;
+    insert(keys, composition.scene, composition.bricks);
+    save();
+}
+
+std::optional<ScenarioIndex::Match>
+ScenarioIndex::nearest(const SceneComposition& composition) const {
+    auto scene = find(composition.scene);
+    if(!scene)
+        return std::nullopt;
+
+    // Bricks no known scenario uses only grow the union
+    ItemBitset query(names.size());
+    uint32_t unknown_bricks = 0;
+    for(auto brick : composition.bricks) {
+        if(ScenarioHash::isSimulationQualityBrick(brick))
+            continue;
+        if(auto id = find(brick))
+            query.set(*id);
+        else
+            ++unknown_bricks;
+    }
+    auto query_count = static_cast<uint32_t>(query.count()) + unknown_bricks;
+
+    std::optional<Match> best;
+    for(const auto& entry : entries) {
+        if(entry.scene != *scene)
+            continue;
+        auto shared = entry.bricks.countAnd(query);
+        auto combined = entry.brick_count + query_count - shared;
+        double similarity = combined == 0 ? 1.0 : double(shared) / combined;
+        if(!best || similarity > best->similarity)
+            best = Match{ entry.keys, similarity };
+    }
+    return best;
+}
+
+size_t ScenarioIndex::size() const {
+    return entries.size();
+}
+
+void ScenarioIndex::save() const {
+    json doc = json::object();
+    char key[17];
+    for(const auto& entry : entries) {
+        snprintf(key, sizeof(key), "%016llX", static_cast<unsigned long long>(entry.keys.stable));
+        auto& value = doc[key];
+        auto& list = value["composition"];
+        list.push_back(names[entry.scene]);
+        entry.bricks.forEach([&](uint32_t id) { list.push_back(names[id]); });
+        snprintf(key, sizeof(key), "%016llX", static_cast<unsigned long long>(entry.keys.legacy));
+        value["legacy"] = key;
+    }
+
+    auto temp_path = path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::trunc);
+        out << doc.dump(1, '\t');
+        if(!out) {
+            LOG_ERROR("ScenarioIndex: could not write %s\n", temp_path.c_str());
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    if(ec)
+        LOG_ERROR("ScenarioIndex: could not write %s: %s\n", path.c_str(), ec.message().c_str());
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "ItemBitset.h"
+#include "Scenario.h"
+
+// Compositions of the scenarios that have a default pool, so that a scenario without one (a new
+// escalation, a different contract mix) can use the pool of the most similar known scenario.
+// Each scenario is kept as its scene resource and a bitset of interned brick names, and is
+// compared by the Jaccard similarity of the brick sets among scenarios of the same scene.
+// Compositions are learned on scene loads and kept in a JSON file keyed like
+// DefaultItemPools.json: { "<stable key>": { "legacy": "<legacy key>", "composition": [scene,
+// bricks...] } }. The legacy key is kept since shipped pool files are keyed by it, and a pool only
+// moves to its stable key once its own scenario is loaded.
+class ScenarioIndex {
+public:
+    struct Match {
+        ScenarioKeys keys;
+        double similarity; // 1 for equal brick sets
+    };
+
+    // A missing or broken file gives an empty index
+    explicit ScenarioIndex(std::string path);
+
+    // Records the composition of a scenario that has a default pool. New scenarios are saved.
+    void add(const ScenarioKeys& keys, const SceneComposition& composition);
+    std::optional<Match> nearest(const SceneComposition& composition) const;
+    size_t size() const;
+
+private:
+    struct Entry {
+        ScenarioKeys keys;
+        uint32_t scene;
+        ItemBitset bricks;
+        uint32_t brick_count;
+    };
+
+    std::string path;
+    std::unordered_map<std::string, uint32_t> name_ids;
+    std::vector<std::string> names;
+    std::vector<Entry> entries;
+    std::unordered_map<Scenario, size_t> entry_of_key;
+
+    uint32_t intern(std::string_view name);
+    std::optional<uint32_t> find(std::string_view name) const;
+    void insert(const ScenarioKeys& keys, std::string_view scene,
+                const std::vector<std::string_view>& bricks);
+    void save() const;
+};
@@ -0,0 +1,62 @@
+#include "SceneArena.h"
+#include <algorithm>
+#include <cstdint>
+
+SceneArena::SceneArena(size_t initial_size) {
+    addBlock(initial_size);
+}
+
+void SceneArena::addBlock(size_t size) {
+    blocks.push_back(Block{ std::make_unique<std::byte[]>(size), size });
+    block_used = 0;
+}
+
+void* SceneArena::do_allocate(size_t bytes, size_t alignment) {
+    auto& block = blocks.back();
+    auto base = reinterpret_cast<uintptr_t>(block.data.get());
+    auto offset = ((base + block_used + alignment - 1) & ~(alignment - 1)) - base;
+    if(offset + bytes > block.size) {
+        // With the alignment slack the allocation always fits into the new block
+        addBlock(std::max(block.size * 2, bytes + alignment));
+        return do_allocate(bytes, alignment);
+    }
+
+    used_bytes += offset + bytes - block_used;
+    peak_bytes = std::max(peak_bytes, used_bytes);
+    block_used = offset + bytes;
+    return block.data.get() + offset;
+}
+
+void SceneArena::do_deallocate(void*, size_t, size_t) {
+}
+
+bool SceneArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+void SceneArena::release() {
+    if(blocks.size() > 1) {
+        size_t total = 0;
+        for(const auto& block : blocks)
+            total += block.size;
+        blocks.clear();
+        addBlock(total);
+    }
+    block_used = 0;
+    used_bytes = 0;
+}
+
+size_t SceneArena::usedBytes() const {
+    return used_bytes;
+}
+
+size_t SceneArena::peakBytes() const {
+    return peak_bytes;
+}
+
+size_t SceneArena::reservedBytes() const {
+    size_t total = 0;
+    for(const auto& block : blocks)
+        total += block.size;
+    return total;
+}
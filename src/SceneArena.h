@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+// Monotonic allocator for the randomisation state of one scene: the randomizers and the scratch
+// space strategies use while they are initialized. Deallocation is a no-op, everything is
+// released at once by release(). Blocks are kept across scenes, so once the arena has grown to
+// the needs of the largest scene loading a scene does no heap allocations at all.
+class SceneArena : public std::pmr::memory_resource {
+public:
+    // Destroys an arena allocated object without freeing its memory.
+    struct Destroy {
+        template <typename T>
+        void operator()(T* object) const {
+            std::destroy_at(object);
+        }
+    };
+
+    template <typename T>
+    using Ptr = std::unique_ptr<T, Destroy>;
+
+    explicit SceneArena(size_t initial_size = 64 * 1024);
+    SceneArena(const SceneArena&) = delete;
+    SceneArena& operator=(const SceneArena&) = delete;
+
+    template <typename T, typename... Args>
+    Ptr<T> create(Args&&... args) {
+        return Ptr<T>(new(allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...));
+    }
+
+    // Makes all memory available again, objects still living in the arena must have been
+    // destroyed. If the last scene needed more than one block they are merged into one.
+    void release();
+
+    // Bytes handed out since the last release, including alignment padding.
+    size_t usedBytes() const;
+    // Highest usedBytes() of any scene so far.
+    size_t peakBytes() const;
+    size_t reservedBytes() const;
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t block_used = 0;
+    size_t used_bytes = 0;
+    size_t peak_bytes = 0;
+
+    void addBlock(size_t size);
+};
@@ -2,6 +2,9 @@
 #include "SceneLoadObserver.h"
 #include "MemoryUtils.h"
 #include "Offsets.h"
+#ifdef PUSHTRACE
+#include "PushTrace.h"
+#endif
 
 
 tLoadScene SceneLoadObserver::o_load_scene = nullptr;
@@ -14,6 +17,9 @@ SceneLoadObserver::SceneLoadObserver(){
 }
 
 uint64_t __fastcall SceneLoadObserver::detour(void* this_, SSceneInitParameters* scene_init_params) {
+#ifdef PUSHTRACE
+	PushTrace::sceneLoad(ScenarioKeys::from(SceneComposition::from(*scene_init_params)));
+#endif
 	for(const auto& callback: load_scene_callbacks)
 		callback(scene_init_params);
 
@@ -0,0 +1,94 @@
+#include "StrategyCache.h"
+#include "Config.h"
+#include "Console.h"
+#include "Hash.h"
+#include "Repository.h"
+
+namespace {
+
+template <typename T>
+std::unique_ptr<RandomisationStrategy> createInstance() {
+    return std::make_unique<T>();
+}
+
+std::unordered_map<std::string, StrategyFactory> worldRandomizers{
+    { "NONE", &createInstance<IdentityRandomisation> },
+    { "DEFAULT", &createInstance<WorldInventoryRandomisation> },
+    { "OOPS_ALL_EXPLOSIVES", &createInstance<OopsAllExplosivesWorldInventoryRandomization> },
+    { "CUSTOM", &createInstance<CustomWorldInventoryRandomization> },
+};
+
+std::unordered_map<std::string, StrategyFactory> npcRandomizers{
+    { "NONE", &createInstance<IdentityRandomisation> },
+    { "DEFAULT", &createInstance<NPCItemRandomisation> },
+    { "HARD", &createInstance<UnrestrictedNPCRandomization> },
+    { "SLEEPY", &createInstance<SleepyNPCRandomization> },
+    { "CUSTOM", &createInstance<CustomNPCRandomization> },
+};
+
+std::unordered_map<std::string, StrategyFactory> heroRandomizers{
+    { "NONE", &createInstance<IdentityRandomisation> },
+    { "DEFAULT", &createInstance<HeroInventoryRandomisation> },
+};
+
+std::unordered_map<std::string, StrategyFactory> stashRandomizers{
+    { "NONE", &createInstance<IdentityRandomisation> },
+    { "DEFAULT", &createInstance<StashInventoryRandomisation> },
+};
+
+} // namespace
+
+const std::unordered_map<std::string, StrategyFactory>& strategyFactories(RandomizerSlot slot) {
+    switch(slot) {
+    case RandomizerSlot::WorldInventory:
+        return worldRandomizers;
+    case RandomizerSlot::NPCInventory:
+        return npcRandomizers;
+    case RandomizerSlot::HeroInventory:
+        return heroRandomizers;
+    default:
+        return stashRandomizers;
+    }
+}
+
+void StrategyCache::beginScene() {
+    retired.clear();
+    ++scene;
+
+    auto generation = RandomDrawRepository::inst().getGeneration();
+    for(auto it = entries.begin(); it != entries.end();) {
+        if(it->second.generation == generation && scene - it->second.last_used <= max_idle_scenes) {
+            ++it;
+            continue;
+        }
+        retired.push_back(std::move(it->second.strategy));
+        it = entries.erase(it);
+    }
+}
+
+RandomisationStrategy& StrategyCache::get(RandomizerSlot slot,
+                                          std::string_view name,
+                                          StrategyFactory factory) {
+    auto key = Hash::combine64(Config::current().hash, static_cast<uint64_t>(slot));
+    key = Hash::combine64(key, Hash::bytes(name.data(), name.size()));
+    auto generation = RandomDrawRepository::inst().getGeneration();
+
+    auto it = entries.find(key);
+    if(it != entries.end() && it->second.generation != generation) {
+        retired.push_back(std::move(it->second.strategy));
+        entries.erase(it);
+        it = entries.end();
+    }
+    if(it == entries.end()) {
+        LOG_DEBUG("StrategyCache: creating %s strategy for slot %d\n", name,
+                  static_cast<int>(slot));
+        it = entries.emplace(key, Entry{ factory(), generation, scene }).first;
+    }
+
+    it->second.last_used = scene;
+    return *it->second.strategy;
+}
+
+size_t StrategyCache::size() const {
+    return entries.size();
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Randomizer.h"
+
+enum class RandomizerSlot { WorldInventory, NPCInventory, HeroInventory, StashInventory };
+
+using StrategyFactory = std::unique_ptr<RandomisationStrategy> (*)();
+
+// Strategies selectable for slot, by their name in the ini
+const std::unordered_map<std::string, StrategyFactory>& strategyFactories(RandomizerSlot slot);
+
+// Owns the randomisation strategies. A strategy is created once per slot, strategy name and
+// config (Config::Snapshot::hash) and reused on every scene load with that config, so the candidate
+// sets, filters and plan storage it builds survive from mission to mission. Strategies bind to the
+// repository snapshot they were created with and are replaced when the repository is reloaded.
+class StrategyCache {
+public:
+    // Called on scene load before get(). Drops strategies of older repository snapshots and those
+    // that weren't used for max_idle_scenes scene loads. Dropped strategies are kept alive until
+    // the next scene load, the randomizers of the previous scene may still use them.
+    void beginScene();
+
+    // Returns the strategy for slot and name under the current config, created with factory if
+    // there is none yet.
+    RandomisationStrategy& get(RandomizerSlot slot, std::string_view name, StrategyFactory factory);
+
+    size_t size() const;
+
+private:
+    struct Entry {
+        std::unique_ptr<RandomisationStrategy> strategy;
+        uint32_t generation;
+        uint64_t last_used;
+    };
+
+    static constexpr uint64_t max_idle_scenes = 8;
+
+    std::unordered_map<uint64_t, Entry> entries;
+    std::vector<std::unique_ptr<RandomisationStrategy>> retired;
+    uint64_t scene = 0;
+};
@@ -0,0 +1,89 @@
+#include "StringArena.h"
+#include <cstring>
+#include "Hash.h"
+
+StringArena::StringArena() : slots(256, empty_slot) {
+    // Chunk pointers are never reallocated, c_str() can read them while strings are appended
+    chunks.reserve(max_chunks);
+}
+
+uint64_t StringArena::hash(std::string_view name) {
+    uint64_t hash = 0xcbf29ce484222325;
+    for(auto c : name) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3;
+    }
+    return Hash::mix64(hash);
+}
+
+uint32_t StringArena::intern(std::string_view name) {
+    auto mask = slots.size() - 1;
+    for(auto slot = hash(name) & mask;; slot = (slot + 1) & mask) {
+        if(slots[slot] == empty_slot) {
+            auto offset = append(name);
+            slots[slot] = offset;
+            if(++count * 2 > slots.size())
+                growSlots();
+            return offset;
+        }
+        if(view(slots[slot]) == name)
+            return slots[slot];
+    }
+}
+
+uint32_t StringArena::append(std::string_view name) {
+    auto size = static_cast<uint32_t>(name.size() + 1);
+    if(size > chunk_size)
+        throw "StringArena: String exceeds chunk size";
+
+    if(chunk_used + size > chunk_size) {
+        if(chunks.size() == max_chunks)
+            throw "StringArena: Arena is full";
+        chunks.push_back(std::make_unique<char[]>(chunk_size));
+        chunk_used = 0;
+    }
+
+    auto offset = static_cast<uint32_t>((chunks.size() - 1) * chunk_size + chunk_used);
+    auto dest = chunks.back().get() + chunk_used;
+    memcpy(dest, name.data(), name.size());
+    dest[name.size()] = '\0';
+    chunk_used += size;
+    used_bytes += size;
+    return offset;
+}
+
+void StringArena::growSlots() {
+    std::vector<uint32_t> old_slots(slots.size() * 2, empty_slot);
+    old_slots.swap(slots);
+
+    auto mask = slots.size() - 1;
+    for(const auto& offset : old_slots) {
+        if(offset == empty_slot)
+            continue;
+        auto slot = hash(view(offset)) & mask;
+        while(slots[slot] != empty_slot)
+            slot = (slot + 1) & mask;
+        slots[slot] = offset;
+    }
+}
+
+const char* StringArena::c_str(uint32_t offset) const {
+    return chunks[offset / chunk_size].get() + offset % chunk_size;
+}
+
+std::string_view StringArena::view(uint32_t offset) const {
+    return std::string_view(c_str(offset));
+}
+
+size_t StringArena::stringCount() const {
+    return count;
+}
+
+size_t StringArena::usedBytes() const {
+    return used_bytes;
+}
+
+size_t StringArena::reservedBytes() const {
+    return chunks.size() * size_t(chunk_size) + chunks.capacity() * sizeof(chunks[0]) +
+           slots.size() * sizeof(uint32_t);
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Append-only store of deduplicated, null terminated strings addressed by 32-bit offsets.
+// Strings live in fixed size chunks that are never moved or freed, so offsets and the
+// pointers returned by c_str() stay valid for the lifetime of the arena.
+class StringArena {
+public:
+    StringArena();
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+
+    // Returns the offset of an equal string if there is one, otherwise appends name.
+    uint32_t intern(std::string_view name);
+
+    const char* c_str(uint32_t offset) const;
+    std::string_view view(uint32_t offset) const;
+
+    size_t stringCount() const;
+    // Bytes used by string data, including terminators.
+    size_t usedBytes() const;
+    // Bytes held by the arena, including chunk slack and the deduplication table.
+    size_t reservedBytes() const;
+
+private:
+    static constexpr uint32_t chunk_size = 1 << 14;
+    static constexpr size_t max_chunks = 1 << 10;
+    static constexpr uint32_t empty_slot = ~uint32_t(0);
+
+    std::vector<std::unique_ptr<char[]>> chunks;
+    uint32_t chunk_used = chunk_size;
+    size_t used_bytes = 0;
+    size_t count = 0;
+    // Open addressing table of offsets for deduplication
+    std::vector<uint32_t> slots;
+
+    static uint64_t hash(std::string_view name);
+    uint32_t append(std::string_view name);
+    void growSlots();
+};
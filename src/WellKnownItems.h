@@ -0,0 +1,83 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include "RepositoryID.h"
+
+// Items the randomisation strategies refer to directly. The ids are compile time literals; the
+// repository resolves them to handles once on load and logs an error if one is missing.
+enum class WellKnownItem : uint8_t {
+    CROWBAR,
+    SCREWDRIVER,
+    WRENCH,
+    FLASH_GRENADE,
+    FRAG_GRENADE,
+    BANANA,
+    COUNT
+};
+
+struct WellKnownItemEntry {
+    WellKnownItem item;
+    const char* name;
+    RepositoryID id;
+};
+
+// Groups of items identified by common name, resolved to candidate sets by the item index.
+enum class WellKnownGroup : uint8_t {
+    EXPLOSIVE_GIFTS,
+    COINS,
+    COUNT
+};
+
+struct WellKnownGroupEntry {
+    WellKnownGroup group;
+    std::span<const std::string_view> common_names;
+};
+
+namespace WellKnownItems {
+
+using namespace GuidLiterals;
+
+// Indexed by WellKnownItem
+inline constexpr WellKnownItemEntry items[] = {
+    { WellKnownItem::CROWBAR, "Crowbar", "01ed6d15-e26e-4362-b1a6-363684a7d0fd"_guid },
+    { WellKnownItem::SCREWDRIVER, "Screwdriver", "12cb6b51-a6dd-4bf5-9653-0ab727820cac"_guid },
+    { WellKnownItem::WRENCH, "Wrench", "6adddf7e-6879-4d51-a7e2-6a25ffdca6ae"_guid },
+    { WellKnownItem::FLASH_GRENADE, "Flash Grenade", "042fae7b-fe9e-4a83-ac7b-5c914a71b2ca"_guid },
+    { WellKnownItem::FRAG_GRENADE, "Frag Grenade", "3f9cf03f-b84f-4419-b831-4704cff9775c"_guid },
+    { WellKnownItem::BANANA, "Banana", "903d273c-c750-441d-916a-31557fea3382"_guid },
+};
+
+inline constexpr std::string_view explosive_gift_names[] = { "Octane Booster",
+                                                             "Explosive Snow Globe" };
+inline constexpr std::string_view coin_names[] = { "(Tool) Coin Cure" };
+
+// Indexed by WellKnownGroup
+inline constexpr WellKnownGroupEntry groups[] = {
+    { WellKnownGroup::EXPLOSIVE_GIFTS, explosive_gift_names },
+    { WellKnownGroup::COINS, coin_names },
+};
+
+static_assert(std::size(items) == static_cast<size_t>(WellKnownItem::COUNT));
+static_assert(std::size(groups) == static_cast<size_t>(WellKnownGroup::COUNT));
+
+constexpr bool entriesInEnumOrder() {
+    for(size_t i = 0; i < std::size(items); ++i)
+        if(static_cast<size_t>(items[i].item) != i)
+            return false;
+    for(size_t i = 0; i < std::size(groups); ++i)
+        if(static_cast<size_t>(groups[i].group) != i)
+            return false;
+    return true;
+}
+static_assert(entriesInEnumOrder());
+
+inline const WellKnownItemEntry& get(WellKnownItem item) {
+    return items[static_cast<size_t>(item)];
+}
+
+inline const WellKnownGroupEntry& get(WellKnownGroup group) {
+    return groups[static_cast<size_t>(group)];
+}
+
+} // namespace WellKnownItems
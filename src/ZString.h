@@ -1,5 +1,6 @@
 #pragma once
 #include <cinttypes>
+#include <cstring>
 #include <string>
 #include <string_view>
 #include "Hash.h"
@@ -23,6 +24,10 @@ struct ZString {
 	std::string to_string() const {
 		return std::string(chars, len);
 	}
+
+	std::string_view view() const {
+		return std::string_view(chars, len);
+	}
 };
 
 template<> struct std::hash<ZString> {
@@ -1,6 +1,7 @@
 # i n c l u d e   " C l i e n t V a l i d a t i o n . h "  
  # i n c l u d e   " C o n f i g . h "  
  # i n c l u d e   " C o n s o l e . h "  
+ # i n c l u d e   " P u s h T r a c e . h "  
  # i n c l u d e   " R a n d o m i s a t i o n M a n . h "  
  # i n c l u d e   " S c e n e L o a d O b s e r v e r . h "  
  # i n c l u d e   < U n k n w n b a s e . h >  
@@ -78,12 +79,15 @@
                          e x i t ( 0 ) ;  
   
                  C o n f i g : : l o a d C o n f i g ( ) ;  
-                 i f ( C o n f i g : : s h o w D e b u g C o n s o l e )  
+                 i f ( C o n f i g : : c u r r e n t ( ) . s h o w D e b u g C o n s o l e )  
                          C o n s o l e : : s p a w n ( ) ;  
   
                  r a n d o m i s a t i o n _ m a n   =   s t d : : m a k e _ u n i q u e < R a n d o m i s a t i o n M a n > ( ) ;  
   
-                 a u t o   l o a d C o n f i g C a l l b a c k   =   [ ] ( c o n s t   S S c e n e I n i t P a r a m e t e r s *   s i p )   {   C o n f i g : : l o a d C o n f i g ( ) ;   } ;  
+                 a u t o   l o a d C o n f i g C a l l b a c k   =   [ ] ( c o n s t   S S c e n e I n i t P a r a m e t e r s *   s i p )   {  
+                         i f ( C o n f i g : : r e l o a d I f C h a n g e d ( ) )  
+                                 L O G _ I N F O ( " R e l o a d e d   c o n f i g \ n " ) ;  
+                 } ;  
                  a u t o   l o a d C a l l b a c k   =   s t d : : b i n d ( & R a n d o m i s a t i o n M a n : : i n i t i a l i z e R a n d o m i z e r s ,  
                                                                              r a n d o m i s a t i o n _ m a n . g e t ( ) ,   s t d : : p l a c e h o l d e r s : : _ 1 ) ;  
   
@@ -95,9 +99,14 @@
                  T e s t I n t e r f a c e : : r u n ( ) ;  
  # e n d i f  
          }   b r e a k ;  
+         c a s e   D L L _ P R O C E S S _ D E T A C H :  
+ # i f d e f   P U S H T R A C E  
+                 P u s h T r a c e : : f l u s h ( ) ;  
+ # e n d i f  
+                 C o n s o l e : : s h u t d o w n ( ) ;  
+                 b r e a k ;  
          c a s e   D L L _ T H R E A D _ A T T A C H :  
          c a s e   D L L _ T H R E A D _ D E T A C H :  
-         c a s e   D L L _ P R O C E S S _ D E T A C H :  
                  b r e a k ;  
          }  
          r e t u r n   T R U E ;  
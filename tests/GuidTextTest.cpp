@@ -0,0 +1,166 @@
+// Fuzzes GuidText against a plain scalar reference: random ids in mixed case, ids with random
+// characters replaced, truncated and extended strings and packed runs for parseMany. Exits with
+// a non-zero status if any result differs.
+#include "Guid.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+int hexValue(char c) {
+    if(c >= '0' && c <= '9')
+        return c - '0';
+    if(c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+// One character at a time, the way the format is specified
+std::optional<Guid> referenceParse(const std::string& text) {
+    if(text.size() != GuidText::length)
+        return std::nullopt;
+    uint8_t bytes[16];
+    size_t byte = 0;
+    for(size_t i = 0; i < text.size();) {
+        if(i == 8 || i == 13 || i == 18 || i == 23) {
+            if(text[i] != '-')
+                return std::nullopt;
+            ++i;
+            continue;
+        }
+        auto high = hexValue(text[i]);
+        auto low = hexValue(text[i + 1]);
+        if(high < 0 || low < 0)
+            return std::nullopt;
+        bytes[byte++] = static_cast<uint8_t>(high << 4 | low);
+        i += 2;
+    }
+
+    Guid guid;
+    guid.Data1 = uint32_t(bytes[0]) << 24 | uint32_t(bytes[1]) << 16 | uint32_t(bytes[2]) << 8 |
+                 bytes[3];
+    guid.Data2 = static_cast<uint16_t>(bytes[4] << 8 | bytes[5]);
+    guid.Data3 = static_cast<uint16_t>(bytes[6] << 8 | bytes[7]);
+    memcpy(guid.Data4, bytes + 8, 8);
+    return guid;
+}
+
+std::string referenceFormat(const Guid& guid) {
+    char text[GuidText::length + 1];
+    snprintf(text, sizeof(text), "%08x-%04x-%04x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+             static_cast<unsigned int>(guid.Data1), guid.Data2, guid.Data3, guid.Data4[0],
+             guid.Data4[1], guid.Data4[2], guid.Data4[3], guid.Data4[4], guid.Data4[5],
+             guid.Data4[6], guid.Data4[7]);
+    return text;
+}
+
+Guid randomGuid(std::mt19937_64& rng) {
+    Guid guid;
+    uint64_t words[2] = { rng(), rng() };
+    memcpy(&guid, words, sizeof(guid));
+    return guid;
+}
+
+// Characters next to the ranges the parser accepts are the likely mistakes, so they are drawn
+// more often than their share of the byte range
+char randomCharacter(std::mt19937_64& rng) {
+    constexpr char edges[] = "/09:@AFG`afg-";
+    if(rng() % 2)
+        return edges[rng() % (sizeof(edges) - 1)];
+    return static_cast<char>(rng());
+}
+
+std::string randomText(std::mt19937_64& rng) {
+    auto text = referenceFormat(randomGuid(rng));
+    for(auto& c : text) {
+        if(rng() % 2)
+            c = static_cast<char>(toupper(static_cast<unsigned char>(c)));
+    }
+    return text;
+}
+
+int failures = 0;
+
+void fail(const char* what, const std::string& text) {
+    if(++failures <= 10)
+        printf("%s mismatch for \"%s\"\n", what, text.c_str());
+}
+
+void check(const std::string& text) {
+    auto expected = referenceParse(text);
+    auto parsed = GuidText::parse(text);
+    if(parsed.has_value() != expected.has_value() || (parsed && !(*parsed == *expected))) {
+        fail("parse", text);
+        return;
+    }
+    if(!parsed)
+        return;
+
+    char formatted[GuidText::length];
+    auto end = GuidText::format(*parsed, formatted);
+    if(end != formatted + GuidText::length ||
+       std::string(formatted, GuidText::length) != referenceFormat(*expected))
+        fail("format", text);
+}
+
+} // namespace
+
+int main() {
+    std::mt19937_64 rng(0x6a1d);
+    constexpr size_t iterations = 200000;
+
+    for(size_t i = 0; i < iterations; ++i) {
+        auto text = randomText(rng);
+        check(text);
+
+        for(auto corruptions = 1 + rng() % 3; corruptions > 0; --corruptions)
+            text[rng() % text.size()] = randomCharacter(rng);
+        check(text);
+
+        // Lengths around the valid one, padded with hex digits so only the length is wrong
+        auto resized = randomText(rng);
+        resized.resize(GuidText::length - 2 + rng() % 5, 'a');
+        check(resized);
+    }
+
+    for(size_t run = 0; run < 1000; ++run) {
+        size_t count = 1 + rng() % 64;
+        size_t invalid = rng() % (count + 1); // count: all valid
+        std::string packed;
+        for(size_t i = 0; i < count; ++i) {
+            auto text = randomText(rng);
+            if(i == invalid)
+                text[rng() % text.size()] = 'x';
+            packed += text;
+        }
+        // A trailing partial id is ignored
+        packed += std::string(rng() % GuidText::length, '0');
+
+        std::vector<Guid> out(count);
+        auto parsed = GuidText::parseMany(packed, out.data());
+        if(parsed != std::min(invalid, count)) {
+            fail("parseMany count", packed.substr(0, 80));
+            continue;
+        }
+        for(size_t i = 0; i < parsed; ++i) {
+            auto expected = referenceParse(packed.substr(i * GuidText::length, GuidText::length));
+            if(!expected || !(out[i] == *expected))
+                fail("parseMany", packed.substr(i * GuidText::length, GuidText::length));
+        }
+    }
+
+    if(failures) {
+        printf("GuidText: %d mismatches\n", failures);
+        return 1;
+    }
+    printf("GuidText: no mismatches\n");
+    return 0;
+}
@@ -0,0 +1,62 @@
+// Checks the scenario keys against the formulas documented in Scenario.h, computed here without
+// the helpers of Scenario.cpp, and the simulation quality brick filter.
+#include "Hash.h"
+#include "Scenario.h"
+#include <cstdio>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void expect(bool condition, const char* what) {
+    if(!condition) {
+        ++failures;
+        printf("failed: %s\n", what);
+    }
+}
+
+uint64_t fnv1a(std::string_view s) {
+    uint64_t hash = 0xcbf29ce484222325;
+    for(auto c : s)
+        hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3;
+    return hash;
+}
+
+} // namespace
+
+int main() {
+    expect(ScenarioHash::isSimulationQualityBrick("assembly:/_pro/scenes/bricks/6core.brick"),
+           "6core is a simulation quality brick");
+    expect(ScenarioHash::isSimulationQualityBrick("Scene_8CoRe_Crowd"),
+           "8core matches in any case");
+    expect(!ScenarioHash::isSimulationQualityBrick("scene_7core"), "7core is kept");
+    expect(!ScenarioHash::isSimulationQualityBrick("6cor"), "6cor is kept");
+
+    constexpr std::string_view scene = "assembly:/_pro/scenes/missions/paris/_scene_paris.entity";
+    const std::vector<std::string_view> bricks = {
+        "assembly:/_pro/scenes/missions/paris/mission_paris_main.brick",
+        "assembly:/_pro/scenes/missions/paris/paris_6core.brick",
+        "assembly:/_pro/scenes/missions/paris/difficulty_pro1.brick",
+    };
+
+    auto stable = Hash::combine64(Hash::mix64(ScenarioHash::version),
+                                  Hash::bytes(scene.data(), scene.size()));
+    auto legacy = fnv1a(scene);
+    for(auto brick : { bricks[0], bricks[2] }) {
+        stable = Hash::combine64(stable, Hash::bytes(brick.data(), brick.size()));
+        legacy = (legacy << 1) ^ fnv1a(brick);
+    }
+
+    auto keys = ScenarioKeys::from(SceneComposition{ scene, bricks });
+    expect(keys.stable == stable, "stable key follows the documented formula");
+    expect(keys.legacy == legacy, "legacy key follows the documented formula");
+    expect(ScenarioHash::stable(scene, {}) != ScenarioHash::stable(scene, bricks),
+           "bricks change the stable key");
+
+    if(failures)
+        return 1;
+    printf("ScenarioHash: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,515 @@
+// Developer benchmarks of the loaders, maps and plans the randomizer uses, run outside the game on
+// the data files of an installation:
+//
+//     Benchmark <game directory>
+//
+// The game directory is the one containing Retail, results are printed to stdout.
+#include "Config.h"
+#include "DefaultItemPoolRepository.h"
+#include "GuidMap.h"
+#include "Item.h"
+#include "ItemPlan.h"
+#include "RNG.h"
+#include "RepositoryID.h"
+#include "SaxLoaders.h"
+#include "StringArena.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <queue>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#ifdef _WIN32
+#include <rpc.h>
+#pragma comment(lib, "Rpcrt4.lib")
+#endif
+
+// All heap allocations of the benchmark go through a size-tracking allocator so that peak heap
+// usage of a single operation can be measured. The replacement is local to this executable.
+namespace {
+
+std::atomic<size_t> heap_current{ 0 };
+std::atomic<size_t> heap_peak{ 0 };
+
+constexpr size_t heap_header_size = 16;
+
+void* trackedAlloc(size_t size) {
+    auto block = static_cast<char*>(std::malloc(size + heap_header_size));
+    if(block == nullptr)
+        throw std::bad_alloc();
+    *reinterpret_cast<size_t*>(block) = size;
+
+    auto current = heap_current.fetch_add(size) + size;
+    auto peak = heap_peak.load();
+    while(current > peak && !heap_peak.compare_exchange_weak(peak, current))
+        ;
+    return block + heap_header_size;
+}
+
+void trackedFree(void* ptr) {
+    if(ptr == nullptr)
+        return;
+    auto block = static_cast<char*>(ptr) - heap_header_size;
+    heap_current.fetch_sub(*reinterpret_cast<size_t*>(block));
+    std::free(block);
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+    return trackedAlloc(size);
+}
+
+void* operator new[](size_t size) {
+    return trackedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    trackedFree(ptr);
+}
+
+namespace {
+
+struct Measurement {
+    double milliseconds;
+    size_t peak_bytes;
+};
+
+// Runs fn and reports its wall time and the peak heap usage above the usage at entry.
+template <typename Fn>
+Measurement measure(Fn&& fn) {
+    auto baseline = heap_current.load();
+    heap_peak = baseline;
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    auto milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+    return { milliseconds, heap_peak.load() - baseline };
+}
+
+void report(const char* name, const Measurement& dom, const Measurement& sax) {
+    printf("%s\n", name);
+    printf("\tDOM: %8.2f ms, peak heap %8zu KiB\n", dom.milliseconds, dom.peak_bytes / 1024);
+    printf("\tSAX: %8.2f ms, peak heap %8zu KiB\n", sax.milliseconds, sax.peak_bytes / 1024);
+}
+
+void benchmarkRepositoryLoad() {
+    auto path = Config::retailPath("Repository.json");
+
+    auto dom = measure([&path] {
+        std::ifstream ifs(path);
+        json repository_json;
+        ifs >> repository_json;
+
+        std::unordered_map<RepositoryID, Item> items;
+        for(const auto& it : repository_json.items()) {
+            ItemDescriptor desc;
+            desc.icon = it.value()["InventoryCategoryIcon"].get<std::string>();
+            desc.cheat_group = it.value()["CheatGroup"].get<std::string>();
+            desc.common_name = it.value()["CommonName"].get<std::string>();
+            desc.throw_type = it.value()["ThrowType"].get<std::string>();
+            desc.silence_rating = it.value().value("SilenceRating", "NONE");
+            items.emplace(RepositoryID(it.key()), Item(desc));
+        }
+    });
+
+    auto sax = measure([&path] {
+        std::unordered_map<RepositoryID, Item> items;
+        RepositorySaxHandler handler([&items](const RepositoryID& id, const ItemDescriptor& desc) {
+            items.emplace(id, Item(desc));
+        });
+        saxParseFile(path, handler);
+    });
+
+    report("Repository.json", dom, sax);
+}
+
+void benchmarkDefaultItemPoolsLoad() {
+    auto path = Config::retailPath("DefaultItemPools.json");
+
+    auto dom = measure([&path] {
+        std::ifstream ifs(path);
+        json pools_json;
+        ifs >> pools_json;
+
+        std::unordered_map<Scenario, std::vector<RepositoryID>> pools;
+        for(const auto& it : pools_json.items()) {
+            auto& ids = pools[std::stoull(it.key(), nullptr, 0x10)];
+            for(const auto& id : it.value())
+                ids.emplace_back(id.get<std::string>());
+        }
+    });
+
+    auto sax = measure([&path] {
+        std::unordered_map<Scenario, std::vector<RepositoryID>> pools;
+        DefaultItemPoolsSaxHandler handler(
+        [&pools](Scenario scen, std::vector<RepositoryID>&& ids) { pools[scen] = std::move(ids); });
+        saxParseFile(path, handler);
+    });
+
+    // What the randomizer loads at startup, pools are decoded on first use
+    auto index = measure([&path] { DefaultItemPoolRepository pools(path); });
+
+    report("DefaultItemPools.json", dom, sax);
+    printf("\tindex: %8.2f ms, peak heap %8zu KiB\n", index.milliseconds, index.peak_bytes / 1024);
+}
+
+const uint32_t* find(const std::unordered_map<RepositoryID, uint32_t>& map,
+                     const RepositoryID& key) {
+    auto it = map.find(key);
+    return it == map.end() ? nullptr : &it->second;
+}
+
+const uint32_t* find(const GuidMap<uint32_t>& map, const RepositoryID& key) {
+    return map.find(key);
+}
+
+// Fills a map with keys, then looks every key up once (hits) and every miss key once (misses).
+// Reports nanoseconds per operation; the sum of found values keeps the lookups alive.
+template <typename Map>
+void benchmarkMap(const char* name,
+                  const std::vector<RepositoryID>& keys,
+                  const std::vector<RepositoryID>& misses) {
+    Map map;
+    uint64_t found = 0;
+
+    auto insert = measure([&] {
+        for(uint32_t i = 0; i < keys.size(); ++i)
+            map[keys[i]] = i;
+    });
+    auto hits = measure([&] {
+        for(const auto& key : keys)
+            if(auto value = find(map, key))
+                found += *value;
+    });
+    auto miss = measure([&] {
+        for(const auto& key : misses)
+            if(auto value = find(map, key))
+                found += *value;
+    });
+
+    auto ns = [](const Measurement& m, size_t ops) { return m.milliseconds * 1e6 / ops; };
+    printf("	%-20s insert %6.1f ns, hit %6.1f ns, miss %6.1f ns, heap %8zu KiB (%llu)\n", name,
+           ns(insert, keys.size()), ns(hits, keys.size()), ns(miss, misses.size()),
+           insert.peak_bytes / 1024, static_cast<unsigned long long>(found));
+}
+
+std::vector<RepositoryID> randomIds(size_t count, std::mt19937_64& rng) {
+    std::vector<RepositoryID> ids(count);
+    for(auto& id : ids) {
+        uint64_t words[2] = { rng(), rng() };
+        memcpy(&id.id, words, sizeof(words));
+    }
+    return ids;
+}
+
+void benchmarkGuidMaps() {
+    std::mt19937_64 rng(0x5eed);
+
+    std::vector<RepositoryID> repository_ids;
+    RepositorySaxHandler handler([&repository_ids](const RepositoryID& id, const ItemDescriptor&) {
+        repository_ids.push_back(id);
+    });
+    saxParseFile(Config::retailPath("Repository.json"), handler);
+
+    const std::pair<const char*, std::vector<RepositoryID>> key_sets[] = {
+        { "Repository ids", repository_ids },
+        { "100k random ids", randomIds(100000, rng) },
+    };
+    for(const auto& [name, keys] : key_sets) {
+        auto misses = randomIds(keys.size(), rng);
+        printf("GUID map, %s (%zu keys)\n", name, keys.size());
+        using StdMap = std::unordered_map<RepositoryID, uint32_t>;
+        benchmarkMap<StdMap>("std::unordered_map", keys, misses);
+        benchmarkMap<GuidMap<uint32_t>>("GuidMap", keys, misses);
+    }
+}
+
+std::string formatGuid(uint64_t hi, uint64_t lo, bool upper) {
+    char text[37];
+    auto format = upper ? "%08X-%04X-%04X-%04X-%012llX" : "%08x-%04x-%04x-%04x-%012llx";
+    snprintf(text, sizeof(text), format,
+             static_cast<unsigned int>(hi >> 32), static_cast<unsigned int>(hi >> 16 & 0xffff),
+             static_cast<unsigned int>(hi & 0xffff), static_cast<unsigned int>(lo >> 48),
+             static_cast<unsigned long long>(lo & 0xffffffffffff));
+    return text;
+}
+
+#ifdef _WIN32
+// Cross-checks RepositoryID::parse against UuidFromStringA on the given and randomly corrupted
+// strings and RepositoryID::text against UuidToStringA, then times the Rpcrt4 functions. Other
+// platforms rely on GuidTextTest for the cross-check.
+void compareWithRpcrt4(const std::vector<std::string>& texts, std::mt19937_64& rng) {
+    auto count = texts.size();
+    size_t mismatches = 0;
+    for(size_t i = 0; i < count; ++i) {
+        auto text = texts[i];
+        for(auto corruptions = rng() % 3; corruptions > 0; --corruptions)
+            text[rng() % text.size()] = static_cast<char>(rng());
+
+        GUID expected;
+        auto expected_valid =
+        UuidFromStringA(reinterpret_cast<unsigned char*>(text.data()), &expected) == RPC_S_OK;
+        auto parsed = RepositoryID::parse(text);
+        if(parsed.has_value() != expected_valid ||
+           (parsed && memcmp(&parsed->id, &expected, sizeof(expected)) != 0))
+            ++mismatches;
+    }
+    printf("\t%zu mismatches against UuidFromStringA\n", mismatches);
+
+    std::vector<RepositoryID> ids(count);
+    auto uuid = measure([&] {
+        for(size_t i = 0; i < count; ++i)
+            UuidFromStringA(reinterpret_cast<unsigned char*>(const_cast<char*>(texts[i].data())),
+                            reinterpret_cast<GUID*>(&ids[i].id));
+    });
+
+    size_t format_mismatches = 0;
+    for(size_t i = 0; i < count; ++i) {
+        unsigned char* expected;
+        UuidToStringA(reinterpret_cast<const GUID*>(&ids[i].id), &expected);
+        if(strcmp(reinterpret_cast<const char*>(expected), ids[i].text().c_str()) != 0)
+            ++format_mismatches;
+        RpcStringFreeA(&expected);
+    }
+    printf("\t%zu mismatches against UuidToStringA\n", format_mismatches);
+
+    size_t checksum = 0;
+    auto uuid_format = measure([&] {
+        for(const auto& id : ids) {
+            unsigned char* text;
+            UuidToStringA(reinterpret_cast<const GUID*>(&id.id), &text);
+            checksum += text[0];
+            RpcStringFreeA(&text);
+        }
+    });
+    auto ns = [count](const Measurement& m) { return m.milliseconds * 1e6 / count; };
+    printf("\tUuidFromStringA %6.1f ns, UuidToStringA %6.1f ns per id (%zu)\n", ns(uuid),
+           ns(uuid_format), checksum);
+}
+#endif
+
+// Times RepositoryID::parse, parseMany and text on random ids in mixed case
+void benchmarkGuidParsing() {
+    std::mt19937_64 rng(0x6a1d);
+    constexpr size_t count = 100000;
+
+    std::vector<std::string> texts;
+    std::string packed;
+    for(size_t i = 0; i < count; ++i) {
+        texts.push_back(formatGuid(rng(), rng(), i & 1));
+        packed += texts.back();
+    }
+
+    std::vector<RepositoryID> ids(count);
+    auto parse = measure([&] {
+        for(size_t i = 0; i < count; ++i)
+            ids[i] = RepositoryID(texts[i]);
+    });
+    auto bulk = measure([&] { RepositoryID::parseMany(packed, ids.data()); });
+
+    size_t checksum = 0;
+    auto format = measure([&] {
+        for(const auto& id : ids)
+            checksum += id.text().chars[0];
+    });
+
+    auto ns = [](const Measurement& m) { return m.milliseconds * 1e6 / count; };
+    printf("GUID parsing and formatting (%zu ids)\n", count);
+    printf("\tparse %6.1f ns, parseMany %6.1f ns, text %6.1f ns per id (%zu)\n", ns(parse),
+           ns(bulk), ns(format), checksum);
+#ifdef _WIN32
+    compareWithRpcrt4(texts, rng);
+#endif
+}
+
+// Decodes the enum attributes of a 10k item synthetic repository, once through node based maps
+// like the ones Item used to have and once through the compile time perfect hashes.
+void benchmarkAttributeDecoding() {
+    const std::unordered_map<std::string, ICON> icon_map{
+        { "melee", ICON::MELEE },
+        { "key", ICON::KEY },
+        { "explosives", ICON::EXPLOSIVE },
+        { "tool", ICON::TOOL },
+        { "pistol", ICON::PISTOL },
+        { "distraction", ICON::DISTRACTION },
+        { "shotgun", ICON::SHOTGUN },
+        { "smg", ICON::SMG },
+        { "sniperrifle", ICON::SNIPERRIFLE },
+    };
+    const std::unordered_map<std::string, CHEAT_GROUP> cheat_group_map{
+        { "eCGNone", CHEAT_GROUP::NONE },       { "eCGDevices", CHEAT_GROUP::DEVICES },
+        { "eCGPistols", CHEAT_GROUP::PISTOLS }, { "eCGSMGs", CHEAT_GROUP::SMGS },
+    };
+    const std::unordered_map<std::string, THROW_TYPE> throw_type_map{
+        { "THROW_NONE", THROW_TYPE::NONE },
+        { "THROW_PACIFY_LIGHT", THROW_TYPE::PACIFY_LIGHT },
+        { "THROW_DEADLY_HEAVY", THROW_TYPE::DEADLY_HEAVY },
+    };
+    const std::unordered_map<std::string, SILENCE_RATING> silence_rating_map{
+        { "NONE", SILENCE_RATING::NONE },
+        { "eSR_Silenced", SILENCE_RATING::SILENCED },
+    };
+
+    std::mt19937_64 rng(0xe1);
+    auto pick = [&rng](const auto& map) {
+        return std::next(map.begin(), rng() % map.size())->first;
+    };
+    constexpr size_t count = 10000;
+    std::vector<ItemDescriptor> descriptors(count);
+    for(auto& desc : descriptors) {
+        desc.icon = pick(icon_map);
+        desc.cheat_group = pick(cheat_group_map);
+        desc.throw_type = pick(throw_type_map);
+        desc.silence_rating = pick(silence_rating_map);
+    }
+
+    size_t checksum = 0;
+    auto maps = measure([&] {
+        for(const auto& desc : descriptors)
+            checksum += static_cast<size_t>(icon_map.at(desc.icon)) +
+                        static_cast<size_t>(cheat_group_map.at(desc.cheat_group)) +
+                        static_cast<size_t>(throw_type_map.at(desc.throw_type)) +
+                        static_cast<size_t>(silence_rating_map.at(desc.silence_rating));
+    });
+    auto perfect = measure([&] {
+        for(const auto& desc : descriptors)
+            checksum += static_cast<size_t>(*Item::parseIcon(desc.icon)) +
+                        static_cast<size_t>(*Item::parseCheatGroup(desc.cheat_group)) +
+                        static_cast<size_t>(*Item::parseThrowType(desc.throw_type)) +
+                        static_cast<size_t>(*Item::parseSilenceRating(desc.silence_rating));
+    });
+
+    printf("Item attribute decoding (%zu items)\n", count);
+    printf("\tunordered_map %6.1f ns, perfect hash %6.1f ns per item (%zu)\n",
+           maps.milliseconds * 1e6 / count, perfect.milliseconds * 1e6 / count, checksum);
+}
+
+// Heap footprint of the repository items with the name embedded in every item, as Item used to
+// store it, against packed items with the names in a string arena.
+void benchmarkItemFootprint() {
+    struct LegacyItem {
+        int icon, cheat_group, throw_type, silence_rating;
+        std::string common_name;
+    };
+
+    std::vector<ItemDescriptor> descriptors;
+    RepositorySaxHandler handler([&descriptors](const RepositoryID&, const ItemDescriptor& desc) {
+        descriptors.push_back(desc);
+    });
+    saxParseFile(Config::retailPath("Repository.json"), handler);
+
+    std::vector<LegacyItem> legacy_items;
+    auto before = measure([&] {
+        legacy_items.reserve(descriptors.size());
+        for(const auto& desc : descriptors)
+            legacy_items.push_back(LegacyItem{ 0, 0, 0, 0, desc.common_name });
+    });
+
+    // Item interns into the shared arena, a local one shows the cost for this repository alone
+    StringArena names;
+    for(const auto& desc : descriptors)
+        names.intern(desc.common_name);
+    auto after = descriptors.size() * sizeof(Item) + names.reservedBytes();
+
+    printf("Repository footprint (%zu items)\n", descriptors.size());
+    printf("\tembedded names: %8zu bytes (%zu per item)\n", before.peak_bytes,
+           before.peak_bytes / std::max<size_t>(descriptors.size(), 1));
+    printf("\tname arena:     %8zu bytes (%zu per item, %zu unique names in %zu bytes)\n", after,
+           after / std::max<size_t>(descriptors.size(), 1), names.stringCount(), names.usedBytes());
+}
+
+// World pool plan as it used to be built, weapons inserted into the shuffled vector and the
+// result copied into a queue, against the linear ItemPlan layout. Every tenth slot is a weapon.
+void benchmarkWorldPlan() {
+    printf("World pool plan\n");
+    std::vector<RepositoryID> ids(1000);
+    for(size_t slots = 100; slots <= 100000; slots *= 10) {
+        std::vector<int> weapon_slots;
+        for(size_t pos = 0; pos < slots; pos += 10)
+            weapon_slots.push_back(static_cast<int>(pos));
+        auto free_count = slots - weapon_slots.size();
+        auto fill = [&](std::span<const RepositoryID*> out) {
+            for(size_t i = 0; i < out.size(); ++i)
+                out[i] = &ids[i % ids.size()];
+        };
+
+        auto before = measure([&] {
+            std::mt19937 rng(1);
+            std::vector<const RepositoryID*> pool(free_count);
+            fill(pool);
+            std::shuffle(pool.begin(), pool.end(), rng);
+            for(size_t i = 0; i < weapon_slots.size(); ++i) {
+                auto slot = std::min<size_t>(weapon_slots[i], pool.size());
+                pool.insert(pool.begin() + slot, &ids[i % ids.size()]);
+            }
+            std::queue<const RepositoryID*> queue;
+            for(const auto& id : pool)
+                queue.push(id);
+        });
+
+        auto after = measure([&] {
+            std::mt19937 rng(1);
+            ItemPlan plan;
+            plan.reset(slots);
+            fill(plan.appendFree(free_count));
+            size_t drawn = 0;
+            auto draw = [&] { return &ids[drawn++ % ids.size()]; };
+            plan.layout(weapon_slots, weapon_slots.size(), rng, draw);
+        });
+
+        printf("\t%6zu slots: insert + queue %9.3f ms, peak heap %6zu KiB | plan %9.3f ms, peak "
+               "heap %6zu KiB\n",
+               slots, before.milliseconds, before.peak_bytes / 1024, after.milliseconds,
+               after.peak_bytes / 1024);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if(argc != 2) {
+        printf("usage: %s <game directory>\n", argv[0]);
+        return 2;
+    }
+    Config::loadConfig(argv[1]);
+
+    try {
+        benchmarkRepositoryLoad();
+        benchmarkDefaultItemPoolsLoad();
+        benchmarkGuidMaps();
+        benchmarkGuidParsing();
+        benchmarkAttributeDecoding();
+        benchmarkItemFootprint();
+        benchmarkWorldPlan();
+    } catch(const char* err) {
+        printf("error: %s\n", err);
+        return 1;
+    } catch(const std::exception& err) {
+        printf("error: %s\n", err.what());
+        return 1;
+    }
+    return 0;
+}
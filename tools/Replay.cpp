@@ -0,0 +1,153 @@
+// Replays a push trace, captured by a build that defines PUSHTRACE, through a strategy outside of
+// the game:
+//
+//     replay <game directory> <trace> <strategy>
+//
+// The strategy is a name as used in the ini (DEFAULT, HARD, ...) and is replayed on every slot
+// that offers it, with the data files of the game directory. Reports throughput, latency
+// percentiles and the distance of the replayed item distribution from the captured one.
+#include "Config.h"
+#include "DefaultItemPoolRepository.h"
+#include "PushTrace.h"
+#include "RNG.h"
+#include "Randomizer.h"
+#include "SceneArena.h"
+#include "StrategyCache.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct ReplayResult {
+    size_t pushes = 0;
+    double milliseconds = 0;
+    std::vector<uint64_t> latencies_ns;
+    // Total variation distance between the replayed and the captured item distribution
+    double distribution_distance = 0;
+    size_t identical = 0;
+};
+
+// Replays the pushes of slot through one instance of the strategy, initialised on every scene
+// load of the trace with the seed and default pool of that scene like in game.
+ReplayResult replayTrace(const std::vector<PushTrace::Event>& events,
+                         RandomizerSlot slot,
+                         StrategyFactory factory,
+                         DefaultItemPoolRepository& pools) {
+    ReplayResult result;
+    SceneArena arena;
+    auto strategy = factory();
+    SceneArena::Ptr<Randomizer> randomizer;
+    ScenarioKeys keys{};
+    std::unordered_map<RepositoryID, std::pair<size_t, size_t>> counts; // captured, replayed
+
+    for(const auto& event : events) {
+        switch(event.type) {
+        case PushTrace::EventType::SceneLoad:
+            keys = ScenarioKeys{ event.scenario, event.legacy_scenario };
+            break;
+        case PushTrace::EventType::Seed: {
+            randomizer.reset();
+            arena.release();
+            randomizer = arena.create<Randomizer>(strategy.get(), &arena);
+            RNG::inst().seed(event.seed);
+            if(auto pool = pools.getDefaultPool(keys))
+                randomizer->initialize(keys.stable, pool);
+            else
+                randomizer->disable();
+        } break;
+        case PushTrace::EventType::Push: {
+            if(event.slot != static_cast<uint8_t>(slot) || !randomizer)
+                break;
+            auto start = std::chrono::steady_clock::now();
+            auto out = randomizer->randomize(&event.in);
+            auto end = std::chrono::steady_clock::now();
+            auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+            result.latencies_ns.push_back(static_cast<uint64_t>(latency.count()));
+            ++counts[event.out].first;
+            ++counts[*out].second;
+            result.identical += *out == event.out;
+        } break;
+        default:
+            break;
+        }
+    }
+
+    result.pushes = result.latencies_ns.size();
+    for(const auto& latency : result.latencies_ns)
+        result.milliseconds += latency / 1e6;
+    for(const auto& [id, count] : counts)
+        result.distribution_distance += std::abs(double(count.first) - double(count.second));
+    if(result.pushes)
+        result.distribution_distance /= 2.0 * result.pushes;
+    std::sort(result.latencies_ns.begin(), result.latencies_ns.end());
+    return result;
+}
+
+void report(const char* slot_name, const ReplayResult& result) {
+    if(result.pushes == 0) {
+        printf("\t%-5s no pushes\n", slot_name);
+        return;
+    }
+    auto percentile = [&](double q) {
+        auto index = std::min(result.pushes - 1, size_t(q * result.pushes));
+        return static_cast<unsigned long long>(result.latencies_ns[index]);
+    };
+    printf("\t%-5s %6zu pushes, %8.3f ms, %7.2f M pushes/s\n", slot_name, result.pushes,
+           result.milliseconds, result.pushes / result.milliseconds / 1000.0);
+    printf("\t      latency p50 %6llu ns, p99 %6llu ns, max %7llu ns\n", percentile(0.5),
+           percentile(0.99), static_cast<unsigned long long>(result.latencies_ns.back()));
+    printf("\t      distribution distance %.3f, identical %5.1f%%\n",
+           result.distribution_distance, 100.0 * result.identical / result.pushes);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if(argc != 4) {
+        printf("usage: %s <game directory> <trace> <strategy>\n", argv[0]);
+        return 2;
+    }
+    Config::loadConfig(argv[1]);
+    const std::string trace = argv[2];
+    const std::string strategy = argv[3];
+
+    const std::pair<RandomizerSlot, const char*> slots[] = {
+        { RandomizerSlot::WorldInventory, "world" },
+        { RandomizerSlot::NPCInventory, "npc" },
+        { RandomizerSlot::HeroInventory, "hero" },
+        { RandomizerSlot::StashInventory, "stash" },
+    };
+
+    try {
+        auto events = PushTrace::read(trace);
+        DefaultItemPoolRepository pools(Config::retailPath("DefaultItemPools.json"));
+        printf("%s: %zu events, strategy %s\n", trace.c_str(), events.size(), strategy.c_str());
+
+        bool replayed = false;
+        for(const auto& [slot, slot_name] : slots) {
+            const auto& factories = strategyFactories(slot);
+            auto factory = factories.find(strategy);
+            if(factory == factories.end())
+                continue;
+            report(slot_name, replayTrace(events, slot, factory->second, pools));
+            replayed = true;
+        }
+        if(!replayed) {
+            printf("no slot has a strategy named %s\n", strategy.c_str());
+            return 2;
+        }
+    } catch(const char* err) {
+        printf("error: %s\n", err);
+        return 1;
+    } catch(const std::exception& err) {
+        printf("error: %s\n", err.what());
+        return 1;
+    }
+    return 0;
+}